@@ -18,8 +18,20 @@
 #include <cmath>
 #include <climits>
 #include <float.h>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
 #include "board.h"
 #include "action.h"
+#include "book.h"
+#include "pattern.h"
+#include "ntuple.h"
+#include "evaluator.h"
+#include "batch.h"
+#include "telemetry.h"
+#include "counters.h"
+#include "trace.h"
 
 class agent {
 public:
@@ -118,6 +130,46 @@ public:
 			std::cout<<"mcts player init"<<std::endl;
 		if(meta.find("T") != meta.end())
 			simulation_times = meta["T"];
+		if(meta.find("book") != meta.end())
+			book.open(meta["book"]);
+		if(meta.find("book_games") != meta.end())
+			book_games = meta["book_games"];
+		bool pattern_rollouts = meta.find("patterns") != meta.end();
+		if(meta.find("rollout") != meta.end())
+			pattern_rollouts = (property("rollout") == "pattern");
+		if(pattern_rollouts) // the tables are only created when used, since every thread creates its own players
+		{
+			patterns.reset(meta.find("patterns") != meta.end() ? new pattern_table(property("patterns")) : new pattern_table());
+			rollout.reset(new pattern_rollout(*patterns));
+		}
+		if(meta.find("ntuple") != meta.end())
+		{
+			network.reset(new ntuple_network<float>());
+			network->load(meta["ntuple"]);
+			cutoff = 0;
+		}
+		if(meta.find("cutoff") != meta.end())
+			cutoff = meta["cutoff"];
+		if(cutoff >= 0 && !network)
+			throw std::invalid_argument("cutoff requires ntuple: " + name());
+		if(meta.find("explore") != meta.end())
+			exploration = meta["explore"];
+		if(meta.find("memory") != meta.end())
+		{
+			node_budget = size_t(double(meta["memory"]) * (1 << 20) / (2 * (sizeof(Node) + sizeof(NodeStats)))); // with the spare pool
+			node_budget = std::max(node_budget, 1 + space.size()); // the root can always be expanded
+			nodes.reserve(node_budget);
+			values.reserve(node_budget);
+			spare_nodes.reserve(node_budget);
+			spare_values.reserve(node_budget);
+		}
+		if(meta.find("telemetry") != meta.end())
+			log_telemetry = (property("telemetry") != "0");
+		if(meta.find("perf") != meta.end() && property("perf") != "0")
+		{
+			search_counters.reset(new perf_counters());
+			rollout_counters.reset(new perf_counters());
+		}
 		// std::cout<<"simulation_times: "<< simulation_times <<std::endl;
 	}
 
@@ -126,112 +178,128 @@ private:
 	std::vector<action::place> space;
 	board::piece_type who;
 	int simulation_times = 1000;
+	opening_book book;
+	unsigned book_games = 1;
+	std::unique_ptr<pattern_table> patterns; // with patterns= or rollout=pattern
+	std::unique_ptr<pattern_rollout> rollout; // by the patterns above
+	std::unique_ptr<ntuple_network<float>> network; // with ntuple=
+	int cutoff = -1; // the rollout length before evaluating by the network, or -1 for full rollouts
+	double exploration = 0.5; // the UCT exploration constant
+	search_telemetry stats; // of the last search
+	bool log_telemetry = false; // print the telemetry of every search to stderr
+	std::unique_ptr<perf_counters> search_counters; // around take_action, with perf=1
+	std::unique_ptr<perf_counters> rollout_counters; // around simulate, with perf=1
+	static constexpr int rollout_sampling = 64; // the rollout counters measure one of this many playouts
 
 public:
-	class Node
-		{
-			public:
-				Node *parent = nullptr;
-				std::vector<Node*> children;
-				board::piece_type placer = board::black;
-				action::place node_move;
-				int n = 0, w = 0;
-				Node():children(){};
-				~Node()
-				{
-					for(Node* child : children)
-						delete child;
-				};
-				bool is_unvisited()
-				{
-					// std::cout<<n<<std::endl;
-					if(n==0)
-						return true;
-					else 
-						return false;
-				}
-		};
+	/**
+	 * the tree is a pool of nodes indexed from the root at 0, where the children of a node are a contiguous block,
+	 * and the statistics (hot, read by every selection) are kept apart from the structure (read once per step),
+	 * so a cache line holds the statistics of 8 siblings
+	 */
+	struct Node
+	{
+		uint32_t first = 0; // the index of the first child
+		uint8_t count = 0; // the number of children
+		uint8_t move = 0; // the position of the move to this node
+		uint8_t placer = board::black; // the color of the move to this node
+		uint8_t terminal = 0; // whether an expansion found no legal move, unlike a leaf collapsed by pruning
+	};
+	struct NodeStats
+	{
+		uint32_t n = 0;
+		float w = 0;
+	};
 
-	Node *select_child(board& state, Node *node, double c = sqrt(2.0))
+	/**
+	 * clear the tree and create the root, whose move was played by 'placer'
+	 * the pool keeps its capacity, so a search allocates nothing once the pool has grown
+	 */
+	uint32_t reset_tree(board::piece_type placer)
+	{
+		nodes.clear();
+		values.clear();
+		nodes.emplace_back();
+		values.emplace_back();
+		nodes[0].placer = placer;
+		return 0;
+	}
+
+	const Node& node(uint32_t i) const { return nodes[i]; }
+	const NodeStats& value(uint32_t i) const { return values[i]; }
+
+	int select_child(board& state, uint32_t node, double c = sqrt(2.0))
 	{
 		double uct_score;
 		double max_score = -1;
-		Node *best_child;
-		// std::cout<<"select child"<<std::endl;
-		if(node->children.size()==0)
-		{
-			// std::cout<<"select child error"<<std::endl;
-			return NULL;
-		}
-		// std::cout<<"select child for"<<std::endl;
-		for(Node* child : node->children)
+		int best_child = -1;
+		const Node& parent = nodes[node];
+		if(parent.count==0)
+			return -1;
+		double log_n = log(values[node].n);
+		for(uint32_t child = parent.first; child < parent.first + parent.count; child++)
 		{
-			if(child->is_unvisited())
+			const NodeStats& stat = values[child];
+			if(stat.n==0)
 				uct_score = DBL_MAX;
 			else
-				uct_score = ((double)child->w / child->n) + c * sqrt(log(child->parent->n)/child->n);
+				uct_score = ((double)stat.w / stat.n) + c * sqrt(log_n/stat.n);
 			if(uct_score > max_score)
 			{
 				max_score = uct_score;
 				best_child = child;
 			}
 		}
-		// best_child->node_move.apply(state);
-		state.place(best_child->node_move.position());
-		// std::cout<<state<<std::endl;
-		// std::cout<<"select child end"<<std::endl;
+		state.place(board::point(nodes[best_child].move));
 		return best_child;
 	}
 
-	Node *select(board& state, Node *root)
+	/**
+	 * descend from the root to a leaf, and keep the nodes on the way in 'path'
+	 */
+	uint32_t select(board& state, std::vector<uint32_t>& path)
 	{
-		Node *node = root;
-		while(node->children.size() != 0)
+		uint32_t node = 0;
+		path.assign(1, node);
+		while(nodes[node].count != 0)
 		{
-			// std::cout<<"select while"<<std::endl;
-			// if(node->node_move == select_child(state, node, root)->node_move)
-			// 	std::cout<<"error: select same node"<<std::endl;
-			node = select_child(state, node, 0.5);
-			// std::cout<<node->children.size()<<std::endl;;
+			node = select_child(state, node, exploration);
+			path.push_back(node);
 		}
-			
 		return node;
 	}
 
-	bool expand(const board& state, Node* node)
+	bool expand(const board& state, uint32_t node)
 	{
 		std::shuffle(space.begin(), space.end(), engine);
-		// std::cout<<"start expand for"<<std::endl;
-		for (const action::place& move : space) 
-		{		
+		uint32_t first = nodes.size();
+		board::piece_type current_placer = reverse_player(board::piece_type(nodes[node].placer));
+		for (const action::place& move : space)
+		{
 			board after = state;
-			board::piece_type current_placer = reverse_player(node->placer);
 			if(after.place(move.position()) == board::legal)
 			{
-				Node* newNode = new Node();
-				newNode->node_move = move;
-				newNode->placer = current_placer;
-				newNode->parent = node;
-				node->children.emplace_back(newNode);
-				// if(node->node_move == newNode->node_move)
-				// {
-				// 	std::cout<<"error: child has same move"<<std::endl;
-				// 	std::cout<<state<<std::endl<<after<<std::endl;
-				// 	std::cout<<node->node_move.position()<<std::endl;
-				// }
- 				// if(newNode->n !=0)
-				// 	std::cout<<"error: newNode n is not 0";
+				nodes.emplace_back();
+				values.emplace_back();
+				nodes.back().move = move.position().i;
+				nodes.back().placer = current_placer;
 			}
 		}
-		// std::cout<<"after expand"<<node->children.size()<<std::endl;
-		if(node->children.size()==0)
+		nodes[node].first = first;
+		nodes[node].count = nodes.size() - first;
+		nodes[node].terminal = (nodes[node].count == 0);
+		if(nodes[node].count==0)
 			return true;
 		else
 			return false;
 	}
 
-	int simulate(const board& state, Node* node)
+	double simulate(const board& state)
 	{
+		if(cutoff >= 0)
+			return evaluate(state);
+		if(rollout)
+			return rollout->run(state, engine) == who ? 0 : 1;
 		board simulate_board(state);
 		bool has_leagal_move = true;
 		while(has_leagal_move)
@@ -255,17 +323,40 @@ public:
 			return 1;
 	}
 
-	bool backpropagation(Node* node, int result)
+	/**
+	 * play at most 'cutoff' random moves, then evaluate the position by the n-tuple network
+	 * return the winning probability of this player
+	 */
+	double evaluate(const board& state)
 	{
-		if(node==nullptr)
+		board simulate_board(state);
+		for(int i = 0; i < cutoff; i++)
+		{
+			bool has_legal_move = false;
+			std::shuffle(space.begin(), space.end(), engine);
+			for(const action::place& move : space)
+			{
+				if(simulate_board.place(move.position()) == board::legal)
+				{
+					has_legal_move = true;
+					break;
+				}
+			}
+			if(!has_legal_move)
+				return simulate_board.get_who_take_turn() == who ? 0 : 1;
+		}
+		double value = network->evaluate(simulate_board);
+		return simulate_board.get_who_take_turn() == who ? value : 1 - value;
+	}
+
+	bool backpropagation(const std::vector<uint32_t>& path, double result)
+	{
+		if(path.empty())
 			return false;
-		while(node!=nullptr)
+		for(uint32_t node : path)
 		{
-			// if(node->n>5000000 || node->n < 0)
-			// 	std::cout<<"error n is not normal"<<std::endl;
-			node->n++;
-			node->w+=result;
-			node = node->parent;
+			values[node].n++;
+			values[node].w+=result;
 		}
 		return true;
 	}
@@ -273,54 +364,164 @@ public:
 	virtual action take_action(const board& state)
 	{
 		// std::cout<<"--------take acion-------"<<std::endl;
-		Node *root = new Node();
-		Node *current_node;
-		// std::cout<<root->w<<std::endl;
-		root->placer = reverse_player(who);
+		stats.clear(); // a book move has no search
+		if(book.size())
+		{
+			int i = book.probe(state, book_games);
+			board after(state);
+			if(i != -1 && action::place(i, who).apply(after) == board::legal)
+				return action::place(i, who);
+		}
+		trace_scope traced("take_action", "search");
+		alloc_counts before = alloc_tracker::local();
+		uint32_t root = reset_tree(reverse_player(who));
+		uint32_t current_node;
+		stats.nodes = 1;
+		if(search_counters)
+			search_counters->start();
+		auto start = std::chrono::steady_clock::now();
+		uint64_t tick = cycles(), tock;
+		trace_phases phases("search");
+		size_t unprunable = 0; // the tree size at which pruning freed nothing
+		size_t samples = 0; // the playouts measured by the rollout counters
 		for(int i=0; i<simulation_times;i++)
 		{
+			if(node_budget && nodes.size() > unprunable && nodes.size() + space.size() > node_budget)
+				unprunable = prune() ? 0 : nodes.size();
 			board current_board(state);
 			//select
-			current_node = select(current_board, root);
+			current_node = select(current_board, path);
+			tock = cycles();
+			stats.cycles[search_telemetry::select] += tock - tick;
+			tick = tock;
+			phases.next("select");
+			size_t depth = path.size() - 1;
 			//expand
-			if(current_node->n==0)
+			if(!nodes[current_node].terminal && (!node_budget || nodes.size() + space.size() <= node_budget))
 			{
-				// if(expand(current_board, current_node))
-				// 	std::cout<<"expand error"<<std::endl;
 				expand(current_board, current_node);
-				// current_node = current_node->children[0];
-				current_node->node_move.apply(current_board);
+				stats.nodes += nodes[current_node].count;
+			}
+			tock = cycles();
+			stats.cycles[search_telemetry::expand] += tock - tick;
+			tick = tock;
+			phases.next("expand");
+			//simulate, where the rollout counters sample every few playouts to keep their syscalls out of the timing
+			bool sampled = rollout_counters && i % rollout_sampling == 0;
+			if(sampled)
+			{
+				rollout_counters->start();
+				tick = cycles();
 			}
-			//simulate
-			int result = simulate(current_board, current_node); 
+			double result = simulate(current_board); 
+			tock = cycles();
+			stats.cycles[search_telemetry::simulate] += tock - tick;
+			tick = tock;
+			if(sampled)
+			{
+				rollout_counters->stop(stats.rollout_events);
+				samples++;
+				tick = cycles();
+			}
+			phases.next("simulate");
 
 			//backpropagation
-			backpropagation(current_node, result);
+			backpropagation(path, result);
+			tock = cycles();
+			stats.cycles[search_telemetry::backpropagate] += tock - tick;
+			tick = tock;
+			phases.next("backpropagate");
+			stats.iterations++;
+			stats.max_depth = std::max(stats.max_depth, depth);
+			stats.sum_depth += depth;
 		}
-		board current_board(state);
-		Node *best_node = select_child(current_board, root, -0.000000001);
-		// action::place best_move = best_node->node_move;
-		action::place best_move;
-		if(best_node)
+		stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		stats.allocations = alloc_tracker::local().allocations - before.allocations;
+		stats.tree_bytes = (nodes.capacity() + spare_nodes.capacity()) * sizeof(Node)
+			+ (values.capacity() + spare_values.capacity()) * sizeof(NodeStats);
+		if(search_counters)
 		{
-			best_move = best_node->node_move;
-			delete root;
-			return best_move;
+			search_counters->stop(stats.search_events);
+			stats.counted = search_counters->available();
+			for(uint64_t& count : stats.rollout_events) // scaled from the sampled playouts to all
+				count = samples ? count * stats.iterations / samples : 0;
+			if(!stats.counted)
+			{
+				std::cerr << "hardware counters are unavailable, perf=1 is ignored" << std::endl;
+				search_counters.reset();
+				rollout_counters.reset();
+			}
 		}
+		for(uint32_t child = nodes[root].first; child < nodes[root].first + nodes[root].count; child++)
+			stats.visits.emplace_back(nodes[child].move, values[child].n);
+		std::stable_sort(stats.visits.begin(), stats.visits.end(),
+			[](const std::pair<int, int>& a, const std::pair<int, int>& b) { return a.second > b.second; });
+		if(log_telemetry)
+			stats.show();
+		board current_board(state);
+		int best_node = select_child(current_board, root, -0.000000001);
+		if(best_node != -1)
+			return action::place(nodes[best_node].move, who);
 		else
-		{
-			delete root;
 			return action();
+	}
+
+	/**
+	 * collapse the least visited subtrees into leaves, until the tree is within 3/4 of the node budget,
+	 * then move the remaining nodes into the spare pool, which becomes the tree
+	 * the collapsed nodes keep their statistics, and are expanded again once the budget has room
+	 * return the number of pruned nodes
+	 */
+	size_t prune()
+	{
+		std::vector<uint32_t> expanded, open(1, 0);
+		while(open.size())
+		{
+			uint32_t node = open.back();
+			open.pop_back();
+			for(uint32_t child = nodes[node].first; child < nodes[node].first + nodes[node].count; child++)
+			{
+				if(nodes[child].count == 0)
+					continue;
+				expanded.push_back(child);
+				open.push_back(child);
+			}
+		}
+		// a child has fewer visits than its parent, so subtrees are collapsed from the bottom
+		std::stable_sort(expanded.begin(), expanded.end(), [&](uint32_t a, uint32_t b) { return values[a].n < values[b].n; });
+		size_t live = nodes.size();
+		for(uint32_t node : expanded)
+		{
+			if(live <= node_budget / 4 * 3)
+				break;
+			live -= nodes[node].count; // the collapsed descendants are already subtracted
+			nodes[node].count = 0;
+		}
+		if(live == nodes.size())
+			return 0;
+
+		// copy the reachable nodes breadth-first, so every block of children stays contiguous
+		spare_nodes.assign(1, nodes[0]);
+		spare_values.assign(1, values[0]);
+		for(size_t i = 0; i < spare_nodes.size(); i++)
+		{
+			uint32_t from = spare_nodes[i].first, count = spare_nodes[i].count;
+			spare_nodes[i].first = spare_nodes.size();
+			spare_nodes.insert(spare_nodes.end(), nodes.begin() + from, nodes.begin() + from + count);
+			spare_values.insert(spare_values.end(), values.begin() + from, values.begin() + from + count);
 		}
-		
-		
-		// if(best_move)
-		// 	return best_move;
-		// else
-		// 	return action();
-		
+		size_t pruned = nodes.size() - spare_nodes.size();
+		nodes.swap(spare_nodes);
+		values.swap(spare_values);
+		stats.pruned += pruned;
+		return pruned;
 	}
-	
+
+	/**
+	 * the telemetry of the last search
+	 */
+	const search_telemetry& telemetry() const { return stats; }
+
 	board::piece_type reverse_player(board::piece_type one_side)
 	{
 		board::piece_type opp_side;
@@ -330,6 +531,193 @@ public:
 			opp_side = board::black;
 		return opp_side;
 	}
+
+private:
+	std::vector<Node> nodes; // the structure of the tree
+	std::vector<NodeStats> values; // the statistics of the tree, parallel to 'nodes'
+	std::vector<Node> spare_nodes; // the pool that the tree is compacted into when pruning
+	std::vector<NodeStats> spare_values;
+	std::vector<uint32_t> path; // the nodes selected in the current iteration
+	size_t node_budget = 0; // the maximum nodes in the tree, by memory=MB, or 0 for unbounded
 };
 
-	
\ No newline at end of file
+	
+
+/**
+ * AlphaZero-style player, selects by PUCT with the priors of an evaluator,
+ * and backs up the value of the evaluator instead of rollouts
+ *
+ * arguments: eval=rollout|ntuple|cnn weights=path T=playouts cpuct=constant
+ *
+ * with threads=N, N search threads share the tree and submit their leaves to an eval_queue,
+ * which evaluates up to batch=B leaves at once or after wait=microseconds,
+ * virtual loss keeps the threads from descending the same path
+ */
+class puct_player : public random_agent {
+public:
+	puct_player(const std::string& args = "") : random_agent("name=puct role=unknown " + args),
+		who(board::empty), playouts(1000), cpuct(1.5f), threads(1) {
+		if (name().find_first_of("[]():; ") != std::string::npos)
+			throw std::invalid_argument("invalid name: " + name());
+		if (role() == "black") who = board::black;
+		if (role() == "white") who = board::white;
+		if (who == board::empty)
+			throw std::invalid_argument("invalid role: " + role());
+		if (meta.find("T") != meta.end())
+			playouts = meta["T"];
+		if (meta.find("cpuct") != meta.end())
+			cpuct = meta["cpuct"];
+		if (meta.find("threads") != meta.end())
+			threads = std::max(1, int(meta["threads"]));
+		std::string type = meta.find("eval") != meta.end() ? property("eval") : "rollout";
+		std::string path = meta.find("weights") != meta.end() ? property("weights") : "";
+		eval = evaluator::create(type, path, engine());
+		if (threads > 1) {
+			size_t batch = meta.find("batch") != meta.end() ? size_t(meta["batch"]) : size_t(threads);
+			long wait = meta.find("wait") != meta.end() ? long(meta["wait"]) : 100;
+			queue.reset(new eval_queue(eval, batch, wait));
+		}
+	}
+
+	virtual action take_action(const board& state) {
+		trace_scope traced("take_action", "search");
+		node root;
+		install(root, state, evaluate(state));
+		visits.fill(0);
+		if (root.children.empty()) return action();
+		std::atomic<int> count(0);
+		std::vector<std::thread> workers;
+		for (int t = 1; t < threads; t++)
+			workers.emplace_back([&]() { search(root, state, count); });
+		search(root, state, count);
+		for (std::thread& worker : workers) worker.join();
+		const node& best = *std::max_element(root.children.begin(), root.children.end(),
+			[](const node& a, const node& b) { return a.n < b.n; });
+		visits.fill(0);
+		for (const node& child : root.children) visits[child.move] = float(child.n) / root.n;
+		return action::place(best.move, who);
+	}
+
+	/**
+	 * the root visit distribution of the last search, over the 1-d indices
+	 */
+	const std::array<float, board::size_x * board::size_y>& policy() const { return visits; }
+
+protected:
+	/**
+	 * 'w' is the total value from the view of the player who made 'move'
+	 */
+	struct node {
+		int move = -1;
+		float prior = 0;
+		int n = 0;
+		float w = 0;
+		bool expanded = false;
+		std::vector<node> children;
+	};
+
+	/**
+	 * run playouts until 'count' reaches the budget, the tree is guarded by 'tree'
+	 * the leaf is evaluated without holding the lock
+	 */
+	void search(node& root, const board& state, std::atomic<int>& count) {
+		while (count++ < playouts) {
+			board current = state;
+			std::vector<node*> path = { &root };
+			std::unique_lock<std::mutex> lock(tree);
+			while (path.back()->expanded && path.back()->children.size()) {
+				node* child = select(*path.back());
+				current.place(board::point(child->move));
+				path.push_back(child);
+			}
+			for (node* n : path) { // virtual loss
+				n->n++;
+				n->w -= 1;
+			}
+			float value = -1.0f; // no legal move
+			if (!path.back()->expanded) {
+				lock.unlock();
+				evaluator::output out = evaluate(current);
+				lock.lock();
+				value = install(*path.back(), current, out);
+			}
+			backup(path, value);
+		}
+	}
+
+	evaluator::output evaluate(const board& state) {
+		if (queue) return queue->submit(state).get();
+		return eval->evaluate(state);
+	}
+
+	/**
+	 * create the children with normalized priors of legal moves, if not yet created by another thread
+	 * return the value for the player to move, -1 if there is no legal move
+	 */
+	float install(node& leaf, const board& state, const evaluator::output& out) {
+		if (leaf.expanded) return leaf.children.size() ? out.value : -1.0f;
+		leaf.expanded = true;
+		float sum = 0;
+		for (int i = 0; i < board::size_x * board::size_y; i++) {
+			board after = state;
+			if (after.place(board::point(i)) != board::legal) continue;
+			leaf.children.emplace_back();
+			leaf.children.back().move = i;
+			leaf.children.back().prior = std::max(out.policy[i], 0.0f);
+			sum += leaf.children.back().prior;
+		}
+		for (node& child : leaf.children)
+			child.prior = sum > 0 ? child.prior / sum : 1.0f / leaf.children.size();
+		return leaf.children.size() ? out.value : -1.0f;
+	}
+
+	node* select(node& parent) {
+		float sqrt_n = std::sqrt(float(parent.n));
+		node* best = nullptr;
+		float best_score = -1e30f;
+		for (node& child : parent.children) {
+			float q = child.n ? child.w / child.n : 0;
+			float score = q + cpuct * child.prior * sqrt_n / (1 + child.n);
+			if (score > best_score) {
+				best_score = score;
+				best = &child;
+			}
+		}
+		return best;
+	}
+
+	/**
+	 * 'value' is for the player to move at the leaf, i.e., the opponent of the player who made the leaf move
+	 * the visits are already counted by the virtual loss, which is replaced by the value
+	 */
+	void backup(const std::vector<node*>& path, float value) {
+		for (auto it = path.rbegin(); it != path.rend(); it++) {
+			value = -value;
+			(*it)->w += value + 1;
+		}
+	}
+
+private:
+	board::piece_type who;
+	int playouts;
+	float cpuct;
+	int threads;
+	std::shared_ptr<evaluator> eval;
+	std::unique_ptr<eval_queue> queue;
+	std::mutex tree;
+	std::array<float, board::size_x * board::size_y> visits = {};
+};
+
+/**
+ * create a player by its 'search' argument, e.g., "search=puct", "search=random", or MCTS by default
+ */
+inline agent* create_player(const std::string& args) {
+	std::string search;
+	std::stringstream ss(args);
+	for (std::string pair; ss >> pair; )
+		if (pair.find("search=") == 0) search = pair.substr(7);
+	for (char& c : search) c = std::tolower(c);
+	if (search == "puct") return new puct_player(args);
+	if (search == "random") return new player(args);
+	return new MCTSplayer(args);
+}
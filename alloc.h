@@ -0,0 +1,143 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * alloc.h: Allocation accounting by a global operator new (make alloc)
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <new>
+#include <atomic>
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <sys/resource.h>
+
+/**
+ * the allocations of a thread since it started, only counted when built with ALLOC_TRACKING
+ */
+struct alloc_counts {
+	uint64_t allocations = 0;
+	uint64_t frees = 0;
+	uint64_t allocated = 0; // in bytes
+	uint64_t freed = 0; // in bytes
+
+	int64_t live() const { return int64_t(allocated) - int64_t(freed); }
+};
+
+class alloc_tracker {
+public:
+#if defined(ALLOC_TRACKING)
+	static constexpr bool enabled = true;
+#else
+	static constexpr bool enabled = false;
+#endif
+
+	/**
+	 * the counts of the calling thread
+	 */
+	static alloc_counts& local() {
+		thread_local alloc_counts counts;
+		return counts;
+	}
+
+	/**
+	 * the bytes allocated and not yet freed by all threads, now and at the peak
+	 */
+	static std::atomic<int64_t>& live() {
+		static std::atomic<int64_t> bytes(0);
+		return bytes;
+	}
+	static std::atomic<int64_t>& peak() {
+		static std::atomic<int64_t> bytes(0);
+		return bytes;
+	}
+
+	/**
+	 * the allocations of all threads
+	 */
+	static std::atomic<uint64_t>& total() {
+		static std::atomic<uint64_t> allocations(0);
+		return allocations;
+	}
+
+	/**
+	 * the peak resident set size in bytes
+	 */
+	static size_t peak_rss() {
+		struct rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		return size_t(usage.ru_maxrss) * 1024;
+	}
+
+	static void allocate(size_t size) {
+		alloc_counts& counts = local();
+		counts.allocations++;
+		counts.allocated += size;
+		total().fetch_add(1, std::memory_order_relaxed);
+		int64_t now = live().fetch_add(size, std::memory_order_relaxed) + size;
+		for (int64_t top = peak().load(std::memory_order_relaxed); now > top; )
+			if (peak().compare_exchange_weak(top, now, std::memory_order_relaxed)) break;
+	}
+
+	static void release(size_t size) {
+		alloc_counts& counts = local();
+		counts.frees++;
+		counts.freed += size;
+		live().fetch_sub(size, std::memory_order_relaxed);
+	}
+
+	/**
+	 * show the summary of the process in a line
+	 *
+	 * the format is
+	 * allocations = 1234567, live = 1.2MB, peak live = 35.6MB, peak rss = 48.0MB
+	 *
+	 * where the values are of all threads
+	 */
+	static void show(std::ostream& out = std::cerr) {
+		const double mb = 1 << 20;
+		out << "allocations = " << total() << ", live = " << live() / mb << "MB, ";
+		out << "peak live = " << peak() / mb << "MB, peak rss = " << peak_rss() / mb << "MB" << std::endl;
+	}
+};
+
+#if defined(ALLOC_TRACKING)
+/**
+ * every block is prefixed by its size, in a header that keeps the alignment of malloc
+ */
+namespace alloc_header {
+	constexpr size_t size = alignof(std::max_align_t);
+}
+
+void* operator new(size_t size) {
+	void* block = std::malloc(size + alloc_header::size);
+	if (!block) throw std::bad_alloc();
+	*static_cast<size_t*>(block) = size;
+	alloc_tracker::allocate(size);
+	return static_cast<char*>(block) + alloc_header::size;
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+	try { return operator new(size); } catch (...) { return nullptr; }
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+	try { return operator new(size); } catch (...) { return nullptr; }
+}
+
+void operator delete(void* ptr) noexcept {
+	if (!ptr) return;
+	void* block = static_cast<char*>(ptr) - alloc_header::size;
+	alloc_tracker::release(*static_cast<size_t*>(block));
+	std::free(block);
+}
+void operator delete[](void* ptr) noexcept { operator delete(ptr); }
+void operator delete(void* ptr, size_t) noexcept { operator delete(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { operator delete(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { operator delete(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { operator delete(ptr); }
+#endif
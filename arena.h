@@ -0,0 +1,200 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * arena.h: Play local games concurrently on all cores
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <string>
+#include <sstream>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <iostream>
+#include "board.h"
+#include "action.h"
+#include "agent.h"
+#include "episode.h"
+#include "statistics.h"
+#include "replay.h"
+#include "trace.h"
+
+/**
+ * unbounded lock-free multi-producer single-consumer queue
+ *
+ * producers push onto an intrusive stack by CAS,
+ * the consumer takes the whole stack at once and reverses it into FIFO order
+ */
+template<typename item_type>
+class mpsc_queue {
+public:
+	mpsc_queue() : top(nullptr) {}
+	mpsc_queue(const mpsc_queue&) = delete;
+	mpsc_queue& operator =(const mpsc_queue&) = delete;
+	~mpsc_queue() { std::vector<item_type> rest; drain(rest); }
+
+public:
+	void push(item_type&& item) {
+		node* n = new node(std::move(item));
+		n->next = top.load(std::memory_order_relaxed);
+		while (!top.compare_exchange_weak(n->next, n, std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	/**
+	 * move all pushed items into 'items' in the order they were pushed
+	 * return the number of items taken
+	 */
+	size_t drain(std::vector<item_type>& items) {
+		node* n = top.exchange(nullptr, std::memory_order_acquire);
+		node* list = nullptr;
+		while (n) { // reverse into FIFO order
+			node* next = n->next;
+			n->next = list;
+			list = n;
+			n = next;
+		}
+		size_t count = 0;
+		while (list) {
+			items.push_back(std::move(list->item));
+			node* next = list->next;
+			delete list;
+			list = next;
+			count++;
+		}
+		return count;
+	}
+
+private:
+	struct node {
+		item_type item;
+		node* next;
+		node(item_type&& item) : item(std::move(item)), next(nullptr) {}
+	};
+	std::atomic<node*> top;
+};
+
+/**
+ * play a game between two agents, and record the positions if 'records' is given
+ */
+inline void play_episode(agent& black, agent& white, episode& game, std::vector<replay_record>* records = nullptr) {
+	black.open_episode("~:" + white.name());
+	white.open_episode(black.name() + ":~");
+	game.open_episode(black.name() + ":" + white.name());
+	trace_scope traced("game", "arena");
+	while (true) {
+		trace_scope traced(game.step() % 2 ? "white" : "black", "move");
+		agent& who = game.take_turns(black, white);
+		board before = game.state();
+		action move = who.take_action(game.state());
+		if (game.apply_action(move) != true) break;
+		if (records) { // record the position and the search policy
+			records->emplace_back();
+			records->back().assign(before);
+			puct_player* search = dynamic_cast<puct_player*>(&who);
+			MCTSplayer* mcts = dynamic_cast<MCTSplayer*>(&who);
+			for (int i = 0; i < replay_record::points; i++)
+				records->back().policy[i] = search ? search->policy()[i] : (i == action::place(move).position().i);
+			if (mcts && mcts->telemetry().iterations) { // the root visits, unless it played from the book
+				float total = 0;
+				for (const std::pair<int, int>& visit : mcts->telemetry().visits) total += visit.second;
+				for (int i = 0; i < replay_record::points; i++) records->back().policy[i] = 0;
+				for (const std::pair<int, int>& visit : mcts->telemetry().visits)
+					records->back().policy[visit.first] = total ? visit.second / total : 0;
+			}
+		}
+		if (who.check_for_win(game.state())) break;
+	}
+	agent& win = game.last_turns(black, white);
+	game.close_episode(win.name());
+	black.close_episode(win.name());
+	white.close_episode(win.name());
+	if (records) {
+		for (replay_record& rec : *records)
+			rec.result = (rec.who == board::black) == (win.role() == "black") ? 1 : -1;
+	}
+}
+
+/**
+ * append a seed to the agent arguments, derived from the given seed (if any) and the worker index
+ */
+inline std::string seed_args(const std::string& args, unsigned worker) {
+	unsigned seed = std::random_device()();
+	std::stringstream ss(args);
+	for (std::string pair; ss >> pair; )
+		if (pair.find("seed=") == 0) seed = std::stoul(pair.substr(5));
+	return args + " seed=" + std::to_string(seed + worker * 7919u);
+}
+
+/**
+ * run local games with 'threads' workers, each owns its own pair of agents
+ *
+ * finished episodes are handed to the main thread through a lock-free queue,
+ * the main thread keeps the statistics, and prints the winners in batches
+ */
+class arena {
+public:
+	arena(const std::string& black_args, const std::string& white_args, size_t threads = 1) {
+		for (size_t t = 0; t < std::max<size_t>(1, threads); t++) { // create in the main thread to report errors
+			std::string black = "name=black " + black_args + " role=black";
+			std::string white = "name=white " + white_args + " role=white";
+			if (threads > 1) {
+				black = seed_args(black, t);
+				white = seed_args(white, t);
+			}
+			players.emplace_back(std::unique_ptr<agent>(create_player(black)), std::unique_ptr<agent>(create_player(white)));
+		}
+	}
+
+public:
+	/**
+	 * play until the statistics is finished, and record the positions into 'replay' if given
+	 */
+	void run(statistics& stats, replay_buffer* replay = nullptr, std::ostream& out = std::cout) {
+		size_t total = stats.is_finished() ? 0 : stats.total_episodes() - stats.step();
+		std::atomic<size_t> next(0);
+		std::vector<std::thread> workers;
+		for (size_t t = 0; t < players.size(); t++) {
+			workers.emplace_back([&, t]() {
+				agent& black = *players[t].first;
+				agent& white = *players[t].second;
+				while (next++ < total) {
+					result res;
+					play_episode(black, white, res.game, replay ? &res.records : nullptr);
+					finished.push(std::move(res));
+				}
+			});
+		}
+
+		std::vector<result> done;
+		for (size_t count = 0; count < total; ) {
+			done.clear();
+			if (finished.drain(done) == 0) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				continue;
+			}
+			for (result& res : done) {
+				if (replay) for (const replay_record& rec : res.records) replay->push(rec);
+				std::string winner = res.game.winner();
+				stats.append(std::move(res.game));
+				out << winner << '\n';
+			}
+			out.flush();
+			count += done.size();
+		}
+		for (std::thread& worker : workers) worker.join();
+	}
+
+private:
+	struct result {
+		episode game;
+		std::vector<replay_record> records;
+	};
+	std::vector<std::pair<std::unique_ptr<agent>, std::unique_ptr<agent>>> players;
+	mpsc_queue<result> finished;
+};
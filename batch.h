@@ -0,0 +1,122 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * batch.h: Asynchronous batched evaluation queue for multi-threaded search
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+#include <chrono>
+#include "board.h"
+#include "evaluator.h"
+
+/**
+ * search threads submit positions, and a dedicated thread evaluates them in batches
+ *
+ * a batch is run as soon as 'batch' positions are pending,
+ * or when the oldest pending position has waited for 'wait' microseconds,
+ * results are delivered by futures or callbacks
+ *
+ * the evaluator is only used by the queue thread, so it needs not to be thread-safe
+ */
+class eval_queue {
+public:
+	typedef std::function<void(const evaluator::output&)> callback;
+
+	eval_queue(std::shared_ptr<evaluator> eval, size_t batch = 16, long wait = 100)
+		: eval(eval), batch(std::max<size_t>(1, batch)), wait(wait), stop(false), batches(0), evaluated(0),
+		  worker(&eval_queue::run, this) {}
+	eval_queue(const eval_queue&) = delete;
+	eval_queue& operator =(const eval_queue&) = delete;
+	~eval_queue() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stop = true;
+		}
+		ready.notify_all();
+		worker.join();
+	}
+
+public:
+	std::future<evaluator::output> submit(const board& state) {
+		std::shared_ptr<std::promise<evaluator::output>> result = std::make_shared<std::promise<evaluator::output>>();
+		std::future<evaluator::output> future = result->get_future();
+		submit(state, [result](const evaluator::output& out) { result->set_value(out); });
+		return future;
+	}
+
+	void submit(const board& state, callback done) {
+		size_t pending;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			queue.push_back({ state, std::move(done), std::chrono::steady_clock::now() });
+			pending = queue.size();
+		}
+		if (pending == 1 || pending >= batch) ready.notify_one();
+	}
+
+	/**
+	 * the number of batches run and positions evaluated so far
+	 */
+	size_t batch_count() const { return batches; }
+	size_t eval_count() const { return evaluated; }
+
+private:
+	struct request {
+		board state;
+		callback done;
+		std::chrono::steady_clock::time_point since;
+	};
+
+	void run() {
+		std::vector<board> states;
+		std::vector<callback> done;
+		std::vector<evaluator::output> out;
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true) {
+			ready.wait(lock, [this]() { return stop || queue.size(); });
+			if (queue.empty()) return; // stop and drained
+			auto deadline = queue.front().since + std::chrono::microseconds(wait);
+			ready.wait_until(lock, deadline, [this]() { return stop || queue.size() >= batch; });
+
+			size_t n = std::min(queue.size(), batch);
+			states.clear();
+			done.clear();
+			for (size_t i = 0; i < n; i++) {
+				states.push_back(queue.front().state);
+				done.push_back(std::move(queue.front().done));
+				queue.pop_front();
+			}
+			lock.unlock();
+			out.resize(n);
+			eval->evaluate(states.data(), n, out.data());
+			for (size_t i = 0; i < n; i++) done[i](out[i]);
+			lock.lock();
+			batches++;
+			evaluated += n;
+		}
+	}
+
+private:
+	std::shared_ptr<evaluator> eval;
+	size_t batch;
+	long wait;
+	bool stop;
+	std::atomic<size_t> batches;
+	std::atomic<size_t> evaluated;
+	std::deque<request> queue;
+	std::mutex mutex;
+	std::condition_variable ready;
+	std::thread worker;
+};
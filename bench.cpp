@@ -0,0 +1,245 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * bench.cpp: Microbenchmarks of the board, action, search, and episode components
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <functional>
+#include <cmath>
+#include "board.h"
+#include "action.h"
+#include "agent.h"
+#include "episode.h"
+
+/**
+ * the timing of a benchmark, in ns per operation over repeated runs
+ */
+struct result {
+	std::string name;
+	size_t ops;
+	double mean, stddev, min;
+};
+
+static volatile uint64_t sink; // keep the results alive
+
+/**
+ * run 'op' for 'repeat' times after a warm-up run, where every run performs 'ops' operations
+ */
+result measure(const std::string& name, size_t ops, size_t repeat, std::function<uint64_t()> op) {
+	std::vector<double> ns;
+	sink += op(); // warm up
+	for (size_t r = 0; r < repeat; r++) {
+		auto start = std::chrono::steady_clock::now();
+		sink += op();
+		auto elapsed = std::chrono::steady_clock::now() - start;
+		ns.push_back(std::chrono::duration<double, std::nano>(elapsed).count() / ops);
+	}
+	double mean = 0, var = 0;
+	for (double t : ns) mean += t;
+	mean /= ns.size();
+	for (double t : ns) var += (t - mean) * (t - mean);
+	var /= std::max<size_t>(1, ns.size() - 1);
+	return { name, ops, mean, std::sqrt(var), *std::min_element(ns.begin(), ns.end()) };
+}
+
+/**
+ * play 'count' random games with the given seed, and collect the positions after random plies
+ */
+std::vector<board> positions(size_t count, unsigned seed, std::vector<episode>* games = nullptr) {
+	std::mt19937 engine(seed);
+	std::vector<board> res;
+	std::vector<int> space(board::size_x * board::size_y);
+	for (size_t i = 0; i < space.size(); i++) space[i] = i;
+	while (res.size() < count) {
+		episode game;
+		game.open_episode("black:white");
+		size_t plies = std::uniform_int_distribution<size_t>(0, 60)(engine);
+		bool taken = false;
+		for (bool moved = true; moved; ) {
+			if (game.step() == plies) {
+				res.push_back(game.state());
+				taken = true;
+			}
+			std::shuffle(space.begin(), space.end(), engine);
+			moved = false;
+			for (int i : space) {
+				if (game.apply_action(action::place(i, game.state().info().who_take_turns))) {
+					moved = true;
+					break;
+				}
+			}
+		}
+		if (!taken) res.push_back(game.state()); // the game ended before the plies
+		game.close_episode(game.step() % 2 ? "black" : "white");
+		if (games) games->push_back(game);
+	}
+	return res;
+}
+
+int main(int argc, const char* argv[]) {
+	size_t count = 256, repeat = 10;
+	unsigned seed = 0;
+	bool json = false;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		auto match_arg = [&](std::string flag) -> bool {
+			auto it = arg.find_first_not_of('-');
+			return arg.find(flag, it) == it;
+		};
+		auto next_opt = [&]() -> std::string {
+			auto it = arg.find('=') + 1;
+			return it ? arg.substr(it) : argv[++i];
+		};
+		if (match_arg("positions")) {
+			count = std::max<size_t>(1, std::stoull(next_opt()));
+		} else if (match_arg("repeat")) {
+			repeat = std::max<size_t>(2, std::stoull(next_opt()));
+		} else if (match_arg("seed")) {
+			seed = std::stoul(next_opt());
+		} else if (match_arg("json")) {
+			json = true;
+		}
+	}
+	if (!json) {
+		std::cout << "HollowNoGo-Bench: ";
+		std::copy(argv, argv + argc, std::ostream_iterator<const char*>(std::cout, " "));
+		std::cout << std::endl << std::endl;
+	}
+
+	std::vector<episode> games;
+	std::vector<board> states = positions(count, seed, &games);
+	const int points = board::size_x * board::size_y;
+	std::vector<result> results;
+
+	results.push_back(measure("board::copy", states.size() * points, repeat, [&]() {
+		uint64_t sum = 0;
+		for (const board& state : states) {
+			for (int i = 0; i < points; i++) {
+				board copy = state;
+				sum += copy(i);
+			}
+		}
+		return sum;
+	}));
+
+	results.push_back(measure("board::place", states.size() * points, repeat, [&]() {
+		uint64_t sum = 0;
+		for (const board& state : states) {
+			for (int i = 0; i < points; i++) {
+				board after = state;
+				sum += after.place(board::point(i));
+			}
+		}
+		return sum;
+	}));
+
+	size_t stones = 0;
+	for (const board& state : states)
+		for (int i = 0; i < points; i++) stones += (state(i) == board::black || state(i) == board::white);
+	results.push_back(measure("board::check_liberty", std::max<size_t>(1, stones), repeat, [&]() {
+		uint64_t sum = 0;
+		for (const board& state : states) {
+			for (int i = 0; i < points; i++) {
+				board::point p(i);
+				if (state(i) == board::black || state(i) == board::white) sum += state.check_liberty(p.x, p.y, state(i));
+			}
+		}
+		return sum;
+	}));
+
+	results.push_back(measure("board::transform", states.size() * 8, repeat, [&]() {
+		uint64_t sum = 0;
+		for (const board& state : states) {
+			for (int s = 0; s < 8; s++) {
+				board copy = state;
+				copy.transform(s);
+				sum += copy(s);
+			}
+		}
+		return sum;
+	}));
+
+	results.push_back(measure("board::hash", states.size(), repeat, [&]() {
+		uint64_t sum = 0;
+		for (const board& state : states) sum += state.hash();
+		return sum;
+	}));
+
+	std::vector<action> moves; // dispatched by the base class
+	for (int i = 0; i < points; i++) moves.push_back(action::place(i, board::black));
+	size_t black_states = 0;
+	for (const board& state : states) black_states += (state.info().who_take_turns == board::black);
+	results.push_back(measure("action::apply", std::max<size_t>(1, black_states * points), repeat, [&]() {
+		uint64_t sum = 0;
+		for (const board& state : states) {
+			if (state.info().who_take_turns != board::black) continue;
+			for (const action& move : moves) {
+				board after = state;
+				sum += move.apply(after);
+			}
+		}
+		return sum;
+	}));
+
+	MCTSplayer black("role=black seed=" + std::to_string(seed)), white("role=white seed=" + std::to_string(seed));
+	auto player = [&](const board& state) -> MCTSplayer& { return state.info().who_take_turns == board::black ? black : white; };
+	results.push_back(measure("MCTSplayer::expand", states.size(), repeat, [&]() {
+		uint64_t sum = 0;
+		for (const board& state : states) {
+			MCTSplayer& mcts = player(state);
+			uint32_t root = mcts.reset_tree(static_cast<board::piece_type>(3u - state.info().who_take_turns)); // the last mover
+			mcts.expand(state, root);
+			sum += mcts.node(root).count;
+		}
+		return sum;
+	}));
+
+	results.push_back(measure("MCTSplayer::simulate", states.size(), repeat, [&]() {
+		uint64_t sum = 0;
+		for (const board& state : states)
+			sum += player(state).simulate(state);
+		return sum;
+	}));
+
+	results.push_back(measure("episode::sgf", games.size(), repeat, [&]() {
+		uint64_t sum = 0;
+		for (const episode& game : games) {
+			std::stringstream sgf;
+			sgf << game;
+			episode parsed;
+			sgf >> parsed;
+			sum += parsed.step();
+		}
+		return sum;
+	}));
+
+	if (json) {
+		std::cout << "[" << std::endl;
+		for (size_t i = 0; i < results.size(); i++) {
+			const result& r = results[i];
+			std::cout << "  {\"name\": \"" << r.name << "\", \"ops\": " << r.ops << ", \"repeat\": " << repeat
+			          << ", \"ns_per_op\": " << r.mean << ", \"stddev\": " << r.stddev << ", \"min\": " << r.min << "}"
+			          << (i + 1 < results.size() ? "," : "") << std::endl;
+		}
+		std::cout << "]" << std::endl;
+	} else {
+		std::cout << std::left << std::setw(24) << "benchmark" << std::right << std::setw(14) << "ns/op"
+		          << std::setw(12) << "stddev" << std::setw(14) << "min" << std::setw(12) << "ops" << std::endl;
+		for (const result& r : results) {
+			std::cout << std::left << std::setw(24) << r.name << std::right << std::fixed << std::setprecision(1)
+			          << std::setw(14) << r.mean << std::setw(12) << r.stddev << std::setw(14) << r.min << std::setw(12) << r.ops << std::endl;
+		}
+	}
+	return 0;
+}
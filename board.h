@@ -139,6 +139,21 @@ public:
 
 	piece_type get_who_take_turn(){	return attr.who_take_turns;}
 
+	/**
+	 * zobrist hash of the stones and the side to move
+	 * the keys are generated from a fixed seed, so hashes are stable across builds
+	 */
+	uint64_t hash() const {
+		uint64_t h = attr.who_take_turns == piece_type::white ? zobrist()[0][piece_type::hollow] : 0;
+		for (int x = 0; x < size_x; x++) {
+			for (int y = 0; y < size_y; y++) {
+				cell c = stone[x][y];
+				if (c == piece_type::black || c == piece_type::white) h ^= zobrist()[x * size_y + y][c];
+			}
+		}
+		return h;
+	}
+
 	/**
 	 * calculate the liberty of the block of piece at [x][y]
 	 * return >= 0 if [x][y] is placed by who; otherwise return -1
@@ -215,6 +230,32 @@ public:
 	void rotate_left() { transpose(); reflect_horizontal(); } // counterclockwise
 	void reverse() { reflect_horizontal(); reflect_vertical(); }
 
+	/**
+	 * apply the s-th of the 8 symmetries, s = 0 ~ 3 are rotations, s = 4 ~ 7 are reflections
+	 */
+	void transform(int s) {
+		if (s & 4) transpose();
+		rotate(s & 3);
+	}
+
+	/**
+	 * the 1-d index where each point goes under transform(s)
+	 */
+	static const std::array<int, size_x * size_y>& symmetry(int s) {
+		typedef std::array<std::array<int, size_x * size_y>, 8> table;
+		static table image = []() {
+			table image;
+			for (int s = 0; s < 8; s++) {
+				board b;
+				for (int i = 0; i < size_x * size_y; i++) b(i) = i;
+				b.transform(s);
+				for (int i = 0; i < size_x * size_y; i++) image[s][b(i)] = i;
+			}
+			return image;
+		}();
+		return image[s & 7];
+	}
+
 public:
 	friend std::ostream& operator <<(std::ostream& out, const board& b) {
 		std::ios ff(nullptr);
@@ -276,6 +317,23 @@ public:
 	}
 
 protected:
+	typedef std::array<std::array<uint64_t, 4>, size_x * size_y> zobrist_keys;
+	static const zobrist_keys& zobrist() {
+		static zobrist_keys keys = []() {
+			zobrist_keys keys;
+			uint64_t seed = 0x9e3779b97f4a7c15ull;
+			for (auto& key : keys) {
+				for (uint64_t& k : key) { // splitmix64
+					uint64_t z = (seed += 0x9e3779b97f4a7c15ull);
+					z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+					z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+					k = z ^ (z >> 31);
+				}
+			}
+			return keys;
+		}();
+		return keys;
+	}
 	static const grid& initial() { static grid stone; return stone; }
 	static __attribute__((constructor)) void init_initial_scheme() {
 		grid& stone = const_cast<grid&>(initial());
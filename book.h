@@ -0,0 +1,173 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * book.h: Opening book built from self-play statistics
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <map>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "board.h"
+#include "action.h"
+
+/**
+ * binary layout of an opening book
+ *
+ * the file is a header followed by entries sorted by (key, move), where
+ *  'key' is the board::hash() of the position before the move
+ *  'move' is the 1-d index of the move
+ *  'games' and 'wins' are counted from the view of the player who made the move
+ */
+struct book_format {
+	static constexpr uint64_t magic = 0x4b4f4f424f474f4eull; // "NOGOBOOK"
+	struct header {
+		uint64_t magic;
+		uint64_t count;
+	};
+	struct entry {
+		uint64_t key;
+		uint32_t move;
+		uint32_t games;
+		uint32_t wins;
+		uint32_t reserved;
+		bool operator <(const entry& e) const { return key < e.key || (key == e.key && move < e.move); }
+	};
+};
+
+/**
+ * aggregate the move outcomes of finished games into a book
+ */
+class book_builder {
+public:
+	/**
+	 * the first 'depth' moves of each episode are collected
+	 */
+	book_builder(size_t depth = 10) : depth(depth) {}
+
+public:
+	/**
+	 * add the move list of a finished game, e.g., episode::actions()
+	 */
+	void add(const std::vector<action>& moves) {
+		board state;
+		unsigned winner = (moves.size() % 2) ? board::black : board::white; // the last mover wins
+		for (size_t i = 0; i < moves.size() && i < depth; i++) {
+			action::place move(moves[i]);
+			book_format::entry& rec = entries[std::make_pair(state.hash(), uint32_t(move.position().i))];
+			rec.games++;
+			rec.wins += (move.color() == winner) ? 1 : 0;
+			if (move.apply(state) != board::legal) break;
+		}
+	}
+
+	size_t size() const { return entries.size(); }
+
+	void save(const std::string& path) const {
+		std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!out) throw std::runtime_error("cannot write book: " + path);
+		book_format::header head = { book_format::magic, entries.size() };
+		out.write(reinterpret_cast<const char*>(&head), sizeof(head));
+		for (const auto& it : entries) { // std::map iterates in (key, move) order
+			book_format::entry rec = it.second;
+			rec.key = it.first.first;
+			rec.move = it.first.second;
+			rec.reserved = 0;
+			out.write(reinterpret_cast<const char*>(&rec), sizeof(rec));
+		}
+	}
+
+private:
+	size_t depth;
+	std::map<std::pair<uint64_t, uint32_t>, book_format::entry> entries;
+};
+
+/**
+ * read-only opening book, memory-mapped at startup
+ */
+class opening_book {
+public:
+	opening_book() : base(nullptr), length(0), head(nullptr), tail(nullptr) {}
+	opening_book(const std::string& path) : opening_book() { open(path); }
+	opening_book(const opening_book&) = delete;
+	opening_book& operator =(const opening_book&) = delete;
+	~opening_book() { close(); }
+
+public:
+	void open(const std::string& path) {
+		close();
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd == -1) throw std::runtime_error("cannot open book: " + path);
+		struct stat st;
+		if (fstat(fd, &st) == -1 || size_t(st.st_size) < sizeof(book_format::header)) {
+			::close(fd);
+			throw std::runtime_error("invalid book: " + path);
+		}
+		void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd);
+		if (addr == MAP_FAILED) throw std::runtime_error("cannot map book: " + path);
+		base = addr;
+		length = st.st_size;
+
+		const book_format::header* hdr = static_cast<const book_format::header*>(base);
+		if (hdr->magic != book_format::magic ||
+			sizeof(book_format::header) + hdr->count * sizeof(book_format::entry) > length) {
+			close();
+			throw std::runtime_error("invalid book: " + path);
+		}
+		head = reinterpret_cast<const book_format::entry*>(hdr + 1);
+		tail = head + hdr->count;
+	}
+
+	void close() {
+		if (base) munmap(base, length);
+		base = nullptr;
+		length = 0;
+		head = tail = nullptr;
+	}
+
+	size_t size() const { return tail - head; }
+	const book_format::entry* begin() const { return head; }
+	const book_format::entry* end() const { return tail; }
+
+	/**
+	 * find the best book move of the given position
+	 * only moves played in at least 'min_games' games are considered
+	 * return the 1-d index of the move, or -1 if the position is not in the book
+	 */
+	int probe(const board& state, unsigned min_games = 1) const {
+		book_format::entry lo = { state.hash(), 0u, 0u, 0u, 0u };
+		book_format::entry hi = { state.hash(), -1u, 0u, 0u, 0u };
+		const book_format::entry* it = std::lower_bound(head, tail, lo);
+		const book_format::entry* last = std::upper_bound(it, tail, hi);
+		int best = -1;
+		double best_rate = -1;
+		for (; it != last; it++) {
+			if (it->games < min_games) continue;
+			double rate = (it->wins + 1.0) / (it->games + 2.0);
+			if (rate > best_rate) {
+				best_rate = rate;
+				best = it->move;
+			}
+		}
+		return best;
+	}
+
+private:
+	void* base;
+	size_t length;
+	const book_format::entry* head;
+	const book_format::entry* tail;
+};
@@ -0,0 +1,389 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * cnn.h: Small residual CNN policy/value network with int8 CPU inference
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <array>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#include "board.h"
+
+/**
+ * int16 dot products of int8-ranged values, the length must be a multiple of 16
+ * dot4 computes four rows of 'b' (at the given stride) against 'a', loading 'a' only once
+ *
+ * the SSE2 and AVX2 versions are compiled by target attributes and selected at runtime,
+ * so the binary runs on any x86-64 machine without -march flags
+ */
+struct cnn_kernel {
+	typedef int32_t (*dot_function)(const int16_t* a, const int16_t* b, size_t n);
+	typedef void (*dot4_function)(const int16_t* a, const int16_t* b, size_t stride, size_t n, int32_t* out);
+
+	static int32_t dot_scalar(const int16_t* a, const int16_t* b, size_t n) {
+		int32_t sum = 0;
+		for (size_t i = 0; i < n; i++) sum += int32_t(a[i]) * b[i];
+		return sum;
+	}
+	static void dot4_scalar(const int16_t* a, const int16_t* b, size_t stride, size_t n, int32_t* out) {
+		for (int r = 0; r < 4; r++) out[r] = dot_scalar(a, b + r * stride, n);
+	}
+
+#if defined(__x86_64__) || defined(__i386__)
+	__attribute__((target("sse2")))
+	static int32_t dot_sse2(const int16_t* a, const int16_t* b, size_t n) {
+		__m128i acc0 = _mm_setzero_si128(), acc1 = _mm_setzero_si128();
+		for (size_t i = 0; i < n; i += 16) {
+			__m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+			__m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+			__m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i + 8));
+			__m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i + 8));
+			acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(a0, b0));
+			acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(a1, b1));
+		}
+		__m128i acc = _mm_add_epi32(acc0, acc1);
+		acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+		acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+		return _mm_cvtsi128_si32(acc);
+	}
+
+	__attribute__((target("sse2")))
+	static void dot4_sse2(const int16_t* a, const int16_t* b, size_t stride, size_t n, int32_t* out) {
+		__m128i acc[4] = { _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128() };
+		for (size_t i = 0; i < n; i += 8) {
+			__m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+			for (int r = 0; r < 4; r++) {
+				__m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + r * stride + i));
+				acc[r] = _mm_add_epi32(acc[r], _mm_madd_epi16(va, vb));
+			}
+		}
+		// transpose and add, so that lane r is the sum of acc[r]
+		__m128i t0 = _mm_add_epi32(_mm_unpacklo_epi32(acc[0], acc[1]), _mm_unpackhi_epi32(acc[0], acc[1]));
+		__m128i t1 = _mm_add_epi32(_mm_unpacklo_epi32(acc[2], acc[3]), _mm_unpackhi_epi32(acc[2], acc[3]));
+		__m128i sum = _mm_add_epi32(_mm_unpacklo_epi64(t0, t1), _mm_unpackhi_epi64(t0, t1));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out), sum);
+	}
+
+	__attribute__((target("avx2")))
+	static int32_t dot_avx2(const int16_t* a, const int16_t* b, size_t n) {
+		__m256i acc = _mm256_setzero_si256();
+		for (size_t i = 0; i < n; i += 16) {
+			__m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+			__m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+			acc = _mm256_add_epi32(acc, _mm256_madd_epi16(va, vb));
+		}
+		__m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+		sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+		sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+		return _mm_cvtsi128_si32(sum);
+	}
+
+	__attribute__((target("avx2")))
+	static void dot4_avx2(const int16_t* a, const int16_t* b, size_t stride, size_t n, int32_t* out) {
+		__m256i acc0 = _mm256_setzero_si256(), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+		for (size_t i = 0; i < n; i += 16) {
+			__m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+			__m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+			__m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + stride + i));
+			__m256i b2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + 2 * stride + i));
+			__m256i b3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + 3 * stride + i));
+			acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(va, b0));
+			acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(va, b1));
+			acc2 = _mm256_add_epi32(acc2, _mm256_madd_epi16(va, b2));
+			acc3 = _mm256_add_epi32(acc3, _mm256_madd_epi16(va, b3));
+		}
+		__m256i sum = _mm256_hadd_epi32(_mm256_hadd_epi32(acc0, acc1), _mm256_hadd_epi32(acc2, acc3));
+		__m128i res = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out), res);
+	}
+#endif
+
+	static bool has_avx2() {
+#if defined(__x86_64__) || defined(__i386__)
+		static bool avx2 = __builtin_cpu_supports("avx2");
+		return avx2;
+#else
+		return false;
+#endif
+	}
+
+	static dot_function dot() {
+#if defined(__x86_64__) || defined(__i386__)
+		return has_avx2() ? dot_avx2 : dot_sse2;
+#else
+		return dot_scalar;
+#endif
+	}
+
+	static dot4_function dot4() {
+#if defined(__x86_64__) || defined(__i386__)
+		return has_avx2() ? dot4_avx2 : dot4_sse2;
+#else
+		return dot4_scalar;
+#endif
+	}
+};
+
+/**
+ * residual CNN over 9x9 input planes
+ *
+ * the input planes are { black, white, hollow, black to move, legal moves }
+ * the network is a 3x3 stem, 'blocks' residual blocks of two 3x3 convolutions,
+ * a 1x1 policy head over the 81 points, and a value head of
+ * global average pooling followed by two fully connected layers
+ *
+ * convolution weights are int8 with a float scale per output channel,
+ * activations are quantized to int8 per position before every convolution,
+ * the fully connected value layers are kept in float since they are tiny
+ */
+class cnn_network {
+public:
+	static constexpr uint64_t magic = 0x314e4e434f474f4eull; // "NOGOCNN1"
+	enum { points = board::size_x * board::size_y, inputs = 5 };
+
+	struct output {
+		std::array<float, points> policy; // probabilities of legal moves, 0 for illegal moves
+		float value; // the expected outcome for the player to move, in [-1, 1]
+	};
+
+	cnn_network() : channels(0), blocks(0), hidden(0) {}
+	cnn_network(const std::string& path) : cnn_network() { load(path); }
+
+public:
+	size_t width() const { return channels; }
+	size_t depth() const { return blocks; }
+	bool empty() const { return channels == 0; }
+
+	/**
+	 * evaluate a batch of positions, the weights of a layer stay in cache across the whole batch
+	 */
+	void evaluate(const board* states, size_t n, output* out) const {
+		if (empty()) throw std::logic_error("evaluate with an empty network");
+		std::vector<float> x(n * points * channels), y(n * points * channels), t(n * points * channels);
+		std::vector<float> in(n * points * inputs);
+		std::vector<std::array<bool, points>> legal(n);
+		for (size_t b = 0; b < n; b++) encode(states[b], &in[b * points * inputs], legal[b]);
+
+		forward(layer[0], in, n, x);
+		relu(x);
+		for (size_t r = 0; r < blocks; r++) {
+			forward(layer[1 + 2 * r], x, n, t);
+			relu(t);
+			forward(layer[2 + 2 * r], t, n, y);
+			for (size_t i = 0; i < y.size(); i++) x[i] = std::max(0.0f, x[i] + y[i]);
+		}
+
+		std::vector<float> logit(n * points);
+		forward(layer[1 + 2 * blocks], x, n, logit);
+		for (size_t b = 0; b < n; b++) {
+			float* p = &logit[b * points];
+			float top = -1e30f, sum = 0;
+			for (int i = 0; i < points; i++) if (legal[b][i]) top = std::max(top, p[i]);
+			for (int i = 0; i < points; i++) sum += (out[b].policy[i] = legal[b][i] ? std::exp(p[i] - top) : 0);
+			for (int i = 0; i < points; i++) out[b].policy[i] = sum > 0 ? out[b].policy[i] / sum : 0;
+
+			std::vector<float> pool(channels, 0), h(hidden);
+			for (int i = 0; i < points; i++)
+				for (size_t c = 0; c < channels; c++) pool[c] += x[(b * points + i) * channels + c] / points;
+			for (size_t j = 0; j < hidden; j++) {
+				float s = fc1_bias[j];
+				for (size_t c = 0; c < channels; c++) s += fc1[j * channels + c] * pool[c];
+				h[j] = std::max(0.0f, s);
+			}
+			float v = fc2_bias;
+			for (size_t j = 0; j < hidden; j++) v += fc2[j] * h[j];
+			out[b].value = std::tanh(v);
+		}
+	}
+	void evaluate(const std::vector<board>& states, std::vector<output>& out) const {
+		out.resize(states.size());
+		evaluate(states.data(), states.size(), out.data());
+	}
+	output evaluate(const board& state) const {
+		output out;
+		evaluate(&state, 1, &out);
+		return out;
+	}
+
+public:
+	/**
+	 * the binary format is
+	 *   magic, channels, blocks, hidden (as uint32),
+	 *   every convolution as int8 weights [cout][k * k][cin], float scales [cout], float biases [cout],
+	 *   and then fc1 [hidden][channels], fc1 biases, fc2 [hidden], fc2 bias in float
+	 */
+	void load(const std::string& path) {
+		std::ifstream in(path, std::ios::in | std::ios::binary);
+		uint64_t head = 0;
+		uint32_t dim[3] = {};
+		in.read(reinterpret_cast<char*>(&head), sizeof(head));
+		in.read(reinterpret_cast<char*>(dim), sizeof(dim));
+		if (!in || head != magic || dim[0] == 0 || dim[0] > 1024 || dim[1] > 256 || dim[2] > 4096)
+			throw std::runtime_error("invalid cnn weights: " + path);
+		shape(dim[0], dim[1], dim[2]);
+		for (conv& l : layer) {
+			std::vector<int8_t> raw(l.cout * l.taps * l.cin);
+			in.read(reinterpret_cast<char*>(raw.data()), raw.size());
+			in.read(reinterpret_cast<char*>(l.scale.data()), l.cout * sizeof(float));
+			in.read(reinterpret_cast<char*>(l.bias.data()), l.cout * sizeof(float));
+			for (size_t o = 0; o < l.cout; o++)
+				for (size_t k = 0; k < l.taps; k++)
+					for (size_t c = 0; c < l.cin; c++)
+						l.weight[o * l.stride + k * l.pad + c] = raw[(o * l.taps + k) * l.cin + c];
+		}
+		in.read(reinterpret_cast<char*>(fc1.data()), fc1.size() * sizeof(float));
+		in.read(reinterpret_cast<char*>(fc1_bias.data()), fc1_bias.size() * sizeof(float));
+		in.read(reinterpret_cast<char*>(fc2.data()), fc2.size() * sizeof(float));
+		in.read(reinterpret_cast<char*>(&fc2_bias), sizeof(float));
+		if (!in) throw std::runtime_error("truncated cnn weights: " + path);
+	}
+
+	void save(const std::string& path) const {
+		std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+		uint64_t head = magic;
+		uint32_t dim[3] = { uint32_t(channels), uint32_t(blocks), uint32_t(hidden) };
+		out.write(reinterpret_cast<const char*>(&head), sizeof(head));
+		out.write(reinterpret_cast<const char*>(dim), sizeof(dim));
+		for (const conv& l : layer) {
+			std::vector<int8_t> raw(l.cout * l.taps * l.cin);
+			for (size_t o = 0; o < l.cout; o++)
+				for (size_t k = 0; k < l.taps; k++)
+					for (size_t c = 0; c < l.cin; c++)
+						raw[(o * l.taps + k) * l.cin + c] = int8_t(l.weight[o * l.stride + k * l.pad + c]);
+			out.write(reinterpret_cast<const char*>(raw.data()), raw.size());
+			out.write(reinterpret_cast<const char*>(l.scale.data()), l.cout * sizeof(float));
+			out.write(reinterpret_cast<const char*>(l.bias.data()), l.cout * sizeof(float));
+		}
+		out.write(reinterpret_cast<const char*>(fc1.data()), fc1.size() * sizeof(float));
+		out.write(reinterpret_cast<const char*>(fc1_bias.data()), fc1_bias.size() * sizeof(float));
+		out.write(reinterpret_cast<const char*>(fc2.data()), fc2.size() * sizeof(float));
+		out.write(reinterpret_cast<const char*>(&fc2_bias), sizeof(float));
+		if (!out) throw std::runtime_error("cannot write cnn weights: " + path);
+	}
+
+	/**
+	 * initialize random weights of the given shape, for testing and benchmarking
+	 */
+	void randomize(size_t channels, size_t blocks, size_t hidden, unsigned seed = 0) {
+		shape(channels, blocks, hidden);
+		std::default_random_engine engine(seed);
+		std::uniform_int_distribution<int> w8(-127, 127);
+		std::normal_distribution<float> w(0, 0.1f);
+		for (conv& l : layer) {
+			for (size_t o = 0; o < l.cout; o++)
+				for (size_t k = 0; k < l.taps; k++)
+					for (size_t c = 0; c < l.cin; c++) l.weight[o * l.stride + k * l.pad + c] = w8(engine);
+			for (float& s : l.scale) s = 1.0f / (127 * std::sqrt(float(l.taps * l.cin)));
+			for (float& b : l.bias) b = w(engine);
+		}
+		for (float& v : fc1) v = w(engine);
+		for (float& v : fc1_bias) v = w(engine);
+		for (float& v : fc2) v = w(engine);
+		fc2_bias = 0;
+	}
+
+protected:
+	struct conv {
+		size_t cin, cout, taps; // taps is 9 for 3x3, 1 for 1x1
+		size_t pad; // cin rounded up to a multiple of 16
+		size_t stride; // taps * pad
+		std::vector<int16_t> weight; // int8 values, [cout][taps][pad]
+		std::vector<float> scale, bias;
+		conv(size_t cin, size_t cout, size_t taps) : cin(cin), cout(cout), taps(taps),
+			pad((cin + 15) / 16 * 16), stride(taps * pad), weight(cout * stride, 0), scale(cout, 1), bias(cout, 0) {}
+	};
+
+	void shape(size_t channels, size_t blocks, size_t hidden) {
+		this->channels = channels;
+		this->blocks = blocks;
+		this->hidden = hidden;
+		layer.clear();
+		layer.emplace_back(inputs, channels, 9);
+		for (size_t r = 0; r < blocks * 2; r++) layer.emplace_back(channels, channels, 9);
+		layer.emplace_back(channels, 1, 1);
+		fc1.assign(hidden * channels, 0);
+		fc1_bias.assign(hidden, 0);
+		fc2.assign(hidden, 0);
+		fc2_bias = 0;
+	}
+
+	static void encode(const board& b, float* plane, std::array<bool, points>& legal) {
+		unsigned who = b.info().who_take_turns;
+		for (int i = 0; i < points; i++) {
+			unsigned cell = b(i);
+			board after = b;
+			legal[i] = cell == board::empty && after.place(board::point(i), who) == board::legal;
+			float* p = plane + i * inputs;
+			p[0] = cell == board::black;
+			p[1] = cell == board::white;
+			p[2] = cell == board::hollow;
+			p[3] = who == board::black;
+			p[4] = legal[i];
+		}
+	}
+
+	/**
+	 * apply a convolution to the activations [n][points][cin] into [n][points][cout]
+	 */
+	static void forward(const conv& l, const std::vector<float>& x, size_t n, std::vector<float>& y) {
+		cnn_kernel::dot_function dot = cnn_kernel::dot();
+		cnn_kernel::dot4_function dot4 = cnn_kernel::dot4();
+		int32_t acc[4];
+		std::vector<int16_t> q(points * l.pad), patch(l.stride);
+		for (size_t b = 0; b < n; b++) {
+			const float* xb = &x[b * points * l.cin];
+			float top = 0;
+			for (size_t i = 0; i < points * l.cin; i++) top = std::max(top, std::abs(xb[i]));
+			float s = top > 0 ? top / 127 : 1;
+			std::fill(q.begin(), q.end(), 0);
+			for (int i = 0; i < points; i++)
+				for (size_t c = 0; c < l.cin; c++) q[i * l.pad + c] = int16_t(std::lround(xb[i * l.cin + c] / s));
+
+			for (int i = 0; i < points; i++) {
+				const int16_t* row = &q[i * l.pad];
+				if (l.taps == 9) {
+					board::point p(i);
+					for (int k = 0; k < 9; k++) {
+						int nx = p.x + k / 3 - 1, ny = p.y + k % 3 - 1;
+						bool inside = nx >= 0 && nx < board::size_x && ny >= 0 && ny < board::size_y;
+						int16_t* dst = &patch[k * l.pad];
+						if (inside) std::copy(&q[board::point(nx, ny).i * l.pad], &q[board::point(nx, ny).i * l.pad] + l.pad, dst);
+						else std::fill(dst, dst + l.pad, 0);
+					}
+					row = patch.data();
+				}
+				float* yb = &y[(b * points + i) * l.cout];
+				size_t o = 0;
+				for (; o + 4 <= l.cout; o += 4) {
+					dot4(row, &l.weight[o * l.stride], l.stride, l.stride, acc);
+					for (int r = 0; r < 4; r++) yb[o + r] = acc[r] * s * l.scale[o + r] + l.bias[o + r];
+				}
+				for (; o < l.cout; o++)
+					yb[o] = dot(row, &l.weight[o * l.stride], l.stride) * s * l.scale[o] + l.bias[o];
+			}
+		}
+	}
+
+	static void relu(std::vector<float>& x) {
+		for (float& v : x) v = std::max(0.0f, v);
+	}
+
+private:
+	size_t channels, blocks, hidden;
+	std::vector<conv> layer;
+	std::vector<float> fc1, fc1_bias, fc2;
+	float fc2_bias;
+};
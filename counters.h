@@ -0,0 +1,99 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * counters.h: Hardware performance counters by Linux perf_event_open
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <array>
+#include <cstring>
+#include <cstdint>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+/**
+ * a group of hardware counters of the calling thread, counting between start() and stop()
+ *
+ * the counters are opened on the first start() in the thread to be measured,
+ * and are unavailable (all zero) if the kernel or the permissions do not allow them,
+ * e.g., in containers or with a high perf_event_paranoid
+ */
+class perf_counters {
+public:
+	enum event { cycles, instructions, cache_misses, branch_misses, events };
+	typedef std::array<uint64_t, events> values;
+
+	perf_counters() : opened(false), fds() { fds.fill(-1); }
+	perf_counters(const perf_counters&) = delete;
+	perf_counters& operator =(const perf_counters&) = delete;
+	~perf_counters() { close(); }
+
+public:
+	bool available() const { return fds[0] != -1; }
+
+	void start() {
+		if (!opened) open();
+#if defined(__linux__)
+		if (available()) {
+			ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+			ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+		}
+#endif
+	}
+
+	/**
+	 * stop counting, and add the counts since start() into 'sum'
+	 */
+	void stop(values& sum) {
+#if defined(__linux__)
+		if (!available()) return;
+		ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+		uint64_t data[1 + events]; // nr, and the values in the order of the group
+		if (read(fds[0], data, sizeof(data)) != ssize_t(sizeof(data))) return;
+		for (size_t i = 0; i < events; i++) sum[i] += data[1 + i];
+#endif
+	}
+
+private:
+	void open() {
+		opened = true;
+#if defined(__linux__)
+		const uint64_t config[] = {
+			PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+		for (size_t i = 0; i < events; i++) {
+			perf_event_attr attr;
+			std::memset(&attr, 0, sizeof(attr));
+			attr.size = sizeof(attr);
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = config[i];
+			attr.disabled = (i == 0); // the group is enabled by the leader
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			attr.read_format = PERF_FORMAT_GROUP;
+			fds[i] = syscall(__NR_perf_event_open, &attr, 0, -1, i ? fds[0] : -1, 0);
+			if (fds[i] == -1) {
+				close();
+				return;
+			}
+		}
+#endif
+	}
+
+	void close() {
+		for (int& fd : fds) {
+			if (fd != -1) ::close(fd);
+			fd = -1;
+		}
+	}
+
+private:
+	bool opened;
+	std::array<int, events> fds;
+};
@@ -14,14 +14,16 @@
 #include <iostream>
 #include <sstream>
 #include <chrono>
+#include <iomanip>
 #include <numeric>
+#include <cmath>
 #include "board.h"
 #include "action.h"
 #include "agent.h"
 
 class episode {
 public:
-	episode() : ep_state(initial_state()), ep_score(0), ep_time(0) {
+	episode() : ep_state(initial_state()), ep_score(0), ep_time(0), ep_nanos() {
 		ep_moves.reserve(board::size_x * board::size_y);
 	}
 
@@ -39,17 +41,25 @@ public:
 	bool apply_action(action move) {
 		board::reward reward = move.apply(state());
 		if (reward != board::legal) return false;
-		ep_moves.emplace_back(move, reward, millisec() - ep_time);
+		time_t spent = nanosec() - ep_time;
+		ep_nanos[step() % 2] += spent;
+		ep_moves.emplace_back(move, reward, spent);
 		ep_score += reward;
 		return true;
 	}
 	agent& take_turns(agent& black, agent& white) {
-		ep_time = millisec();
+		ep_time = nanosec();
 		return (step() % 2) ? white : black;
 	}
 	agent& last_turns(agent& black, agent& white) {
 		return take_turns(white, black);
 	}
+	std::string winner() const {
+		return ep_close.tag;
+	}
+	std::string players() const {
+		return ep_open.tag;
+	}
 
 public:
 	size_t step(unsigned who = -1u) const {
@@ -64,23 +74,41 @@ public:
 		}
 	}
 
+	/**
+	 * the thinking time of a side in milliseconds, or the duration of the whole episode
+	 */
 	time_t time(unsigned who = -1u) const {
-		time_t time = 0;
 		switch (who) {
 		case board::black:
 		case action::black::type:
-			for (size_t i = 0; i < ep_moves.size(); i += 2) time += ep_moves[i].time;
-			break;
 		case board::white:
 		case action::white::type:
-			for (size_t i = 1; i < ep_moves.size(); i += 2) time += ep_moves[i].time;
-			break;
+			return nanos(who) / 1000000;
 		case action::place::type:
 		default:
-			time = ep_close.when - ep_open.when;
-			break;
+			return ep_close.when - ep_open.when;
 		}
-		return time;
+	}
+
+	/**
+	 * the thinking time of a side in nanoseconds, or of both sides
+	 */
+	time_t nanos(unsigned who = -1u) const {
+		switch (who) {
+		case board::black:
+		case action::black::type: return ep_nanos[0];
+		case board::white:
+		case action::white::type: return ep_nanos[1];
+		case action::place::type:
+		default:                  return ep_nanos[0] + ep_nanos[1];
+		}
+	}
+
+	/**
+	 * the thinking time of the i-th move in nanoseconds
+	 */
+	time_t nanos_at(size_t i) const {
+		return ep_moves[i].time;
 	}
 
 	std::vector<action> actions(unsigned who = -1u) const {
@@ -118,6 +146,10 @@ public:
 		std::string winner = ep.ep_close.tag;
 		out << "RE[" << (names.find(winner) == 0 ? "B" : "W") << "+R]";
 		out << "C[TCG|" << ep.ep_open << "|" << ep.ep_close << "]";
+		if (std::any_of(ep.ep_moves.begin(), ep.ep_moves.end(), [](const move& mv) { return mv.time % 1000000; })) {
+			out << "NS"; // the sub-millisecond remainders of the move times, skipped by older builds
+			for (const move& mv : ep.ep_moves) out << "[" << std::dec << (mv.time % 1000000) << "]";
+		}
 		for (const move& mv : ep.ep_moves) out << mv;
 		out << ')';
 		return out;
@@ -134,10 +166,17 @@ public:
 			ss.ignore(1); // |
 			ss >> ep.ep_close;
 			ss.ignore(1); // ]
+			std::vector<time_t> remainders;
+			if (ss.peek() == 'N' && ss.ignore(2)) { // NS[...][...]
+				for (time_t ns; ss.peek() == '[' && ss.ignore(1) && ss >> std::dec >> ns; ss.ignore(1))
+					remainders.push_back(ns);
+			}
 			while (ss.peek() != ';' && ss.ignore(1));
 			while (ss.peek() == ';') {
 				ep.ep_moves.emplace_back();
 				ss >> ep.ep_moves.back();
+				if (ep.ep_moves.size() <= remainders.size()) ep.ep_moves.back().time += remainders[ep.ep_moves.size() - 1];
+				ep.ep_nanos[(ep.ep_moves.size() - 1) % 2] += ep.ep_moves.back().time;
 			}
 			ep.ep_score = 0;
 		} else {
@@ -151,13 +190,18 @@ protected:
 	struct move {
 		action code;
 		board::reward reward;
-		time_t time;
+		time_t time; // in nanoseconds
 		move(action code = {}, board::reward reward = 0, time_t time = 0) : code(code), reward(reward), time(time) {}
 
 		operator action() const { return code; }
+		/**
+		 * the time is written in integral milliseconds, e.g., C[12], as read by older builds,
+		 * and the remainders in nanoseconds are written in the root node by the episode
+		 * records with fractional milliseconds, e.g., C[12.345678], are also readable
+		 */
 		friend std::ostream& operator <<(std::ostream& out, const move& m) {
 			out << m.code;
-			if (m.time) out << "C[" << std::dec << m.time << "]";
+			if (m.time) out << "C[" << std::dec << (m.time / 1000000) << "]";
 			return out;
 		}
 		friend std::istream& operator >>(std::istream& in, move& m) {
@@ -166,7 +210,9 @@ protected:
 			m.time = 0;
 			if (in.peek() == 'C') {
 				in.ignore(2); // C[
-				in >> std::dec >> m.time;
+				double ms = 0;
+				in >> std::dec >> ms;
+				m.time = std::llround(ms * 1000000);
 				in.ignore(1); // ]
 			}
 			return in;
@@ -193,12 +239,17 @@ protected:
 		auto now = std::chrono::system_clock::now().time_since_epoch();
 		return std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
 	}
+	static time_t nanosec() { // monotonic, for measuring the moves
+		auto now = std::chrono::steady_clock::now().time_since_epoch();
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+	}
 
 private:
 	board ep_state;
 	board::score ep_score;
 	std::vector<move> ep_moves;
 	time_t ep_time;
+	time_t ep_nanos[2]; // the thinking time of black and white
 
 	meta ep_open;
 	meta ep_close;
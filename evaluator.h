@@ -0,0 +1,144 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * evaluator.h: Common interface of policy/value evaluators
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <array>
+#include <vector>
+#include <string>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include "board.h"
+#include "ntuple.h"
+#include "cnn.h"
+
+/**
+ * an evaluator gives the move priors and the value of positions
+ *
+ * the priors need not be normalized and may be nonzero for illegal moves,
+ * the value is the expected outcome for the player to move, in [-1, 1]
+ */
+class evaluator {
+public:
+	enum { points = board::size_x * board::size_y };
+	struct output {
+		std::array<float, points> policy;
+		float value;
+	};
+
+	virtual ~evaluator() {}
+
+	/**
+	 * evaluate a batch of positions
+	 */
+	virtual void evaluate(const board* states, size_t n, output* out) = 0;
+
+	output evaluate(const board& state) {
+		output out;
+		evaluate(&state, 1, &out);
+		return out;
+	}
+
+	/**
+	 * create an evaluator by its type, i.e., "rollout", "ntuple", or "cnn",
+	 * where 'path' is the weight file of the network
+	 */
+	static std::shared_ptr<evaluator> create(const std::string& type, const std::string& path = "", unsigned seed = 0);
+};
+
+/**
+ * uniform priors, and the value of a single random rollout
+ */
+class rollout_evaluator : public evaluator {
+public:
+	rollout_evaluator(unsigned seed = 0) : engine(seed) {}
+
+	virtual void evaluate(const board* states, size_t n, output* out) {
+		for (size_t b = 0; b < n; b++) {
+			out[b].policy.fill(1.0f);
+			out[b].value = rollout(states[b]);
+		}
+	}
+
+protected:
+	float rollout(const board& state) {
+		board current = state;
+		unsigned who = state.info().who_take_turns;
+		std::array<int, points> space;
+		for (int i = 0; i < points; i++) space[i] = i;
+		for (unsigned mover = who; ; mover = 3u - mover) {
+			std::shuffle(space.begin(), space.end(), engine);
+			int i = 0;
+			while (i < points && current.place(board::point(space[i]), mover) != board::legal) i++;
+			if (i == points) return mover == who ? -1.0f : 1.0f;
+		}
+	}
+
+private:
+	std::default_random_engine engine;
+};
+
+/**
+ * the value of the n-tuple network, and priors by the softmax of the afterstate values
+ */
+class ntuple_evaluator : public evaluator {
+public:
+	ntuple_evaluator(const std::string& path, float temperature = 0.25f) : temperature(temperature) {
+		network.load(path);
+	}
+
+	virtual void evaluate(const board* states, size_t n, output* out) {
+		for (size_t b = 0; b < n; b++) {
+			const board& state = states[b];
+			std::array<float, points> value;
+			float top = -1e30f;
+			for (int i = 0; i < points; i++) {
+				board after = state;
+				value[i] = after.place(board::point(i)) == board::legal ? -network.estimate(after) : -1e30f;
+				top = std::max(top, value[i]);
+			}
+			for (int i = 0; i < points; i++)
+				out[b].policy[i] = value[i] > -1e29f ? std::exp((value[i] - top) / temperature) : 0;
+			out[b].value = std::max(-1.0f, std::min(1.0f, network.estimate(state)));
+		}
+	}
+
+private:
+	ntuple_network<float> network;
+	float temperature;
+};
+
+/**
+ * the policy and value heads of the CNN
+ */
+class cnn_evaluator : public evaluator {
+public:
+	cnn_evaluator(const std::string& path) : network(path) {}
+
+	virtual void evaluate(const board* states, size_t n, output* out) {
+		std::vector<cnn_network::output> res(n);
+		network.evaluate(states, n, res.data());
+		for (size_t b = 0; b < n; b++) {
+			out[b].policy = res[b].policy;
+			out[b].value = res[b].value;
+		}
+	}
+
+private:
+	cnn_network network;
+};
+
+inline std::shared_ptr<evaluator> evaluator::create(const std::string& type, const std::string& path, unsigned seed) {
+	if (type == "rollout") return std::make_shared<rollout_evaluator>(seed);
+	if (type == "ntuple") return std::make_shared<ntuple_evaluator>(path);
+	if (type == "cnn") return std::make_shared<cnn_evaluator>(path);
+	throw std::invalid_argument("unknown evaluator: " + type);
+}
@@ -0,0 +1,96 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * histogram.h: HDR-style latency histogram with percentiles
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <array>
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include <cstdint>
+
+/**
+ * log-linear buckets of nonnegative values, e.g., latencies in nanoseconds
+ *
+ * values below 2^sub_bits are exact, and larger values are grouped by their highest bit
+ * into 2^sub_bits linear sub-buckets, so every bucket is within 1 / 2^sub_bits relative error
+ */
+class latency_histogram {
+public:
+	enum { sub_bits = 6, sub_buckets = 1 << sub_bits, groups = 64 - sub_bits + 1 };
+
+	latency_histogram() { clear(); }
+
+public:
+	void clear() {
+		buckets.fill(0);
+		total = 0;
+		sum = 0;
+		top = 0;
+	}
+
+	void record(uint64_t value) {
+		buckets[index(value)]++;
+		total++;
+		sum += value;
+		top = std::max(top, value);
+	}
+
+	uint64_t count() const { return total; }
+	uint64_t max() const { return top; }
+	double mean() const { return total ? sum * 1.0 / total : 0; }
+
+	/**
+	 * the value at the given percentile in [0, 100], as the upper bound of its bucket
+	 */
+	uint64_t percentile(double p) const {
+		if (total == 0) return 0;
+		uint64_t rank = std::max<uint64_t>(1, uint64_t(p / 100 * total + 0.5));
+		uint64_t seen = 0;
+		for (size_t i = 0; i < buckets.size(); i++) {
+			seen += buckets[i];
+			if (seen >= rank) return std::min(top, upper(i));
+		}
+		return top;
+	}
+
+	/**
+	 * summarize the histogram in a line, with the values divided by 'unit', e.g., 1e6 for ns to ms
+	 *
+	 * the format is
+	 * count = 120, mean = 81.2, p50 = 80.1, p90 = 95.3, p99 = 140.7, max = 151.2
+	 */
+	std::string summary(double unit = 1) const {
+		std::stringstream ss;
+		ss << "count = " << count() << ", mean = " << mean() / unit;
+		ss << ", p50 = " << percentile(50) / unit << ", p90 = " << percentile(90) / unit;
+		ss << ", p99 = " << percentile(99) / unit << ", max = " << max() / unit;
+		return ss.str();
+	}
+
+private:
+	static size_t index(uint64_t value) {
+		if (value < sub_buckets) return value;
+		int msb = 63 - __builtin_clzll(value);
+		int shift = msb - sub_bits;
+		return (shift + 1) * sub_buckets + ((value >> shift) - sub_buckets);
+	}
+
+	static uint64_t upper(size_t i) {
+		if (i < sub_buckets) return i;
+		size_t shift = i / sub_buckets - 1;
+		uint64_t base = (i % sub_buckets + sub_buckets) << shift;
+		return base + ((uint64_t(1) << shift) - 1);
+	}
+
+private:
+	std::array<uint64_t, groups * sub_buckets> buckets;
+	uint64_t total;
+	uint64_t sum;
+	uint64_t top;
+};
@@ -0,0 +1,165 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * mm.cpp: Minorization-maximization (Bradley-Terry) trainer for 3x3 pattern weights
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <thread>
+#include <cmath>
+#include "board.h"
+#include "action.h"
+#include "episode.h"
+#include "statistics.h"
+#include "pattern.h"
+
+/**
+ * every played move is a competition among the patterns of all legal moves,
+ * where the pattern of the played move is the winner
+ *
+ * the patterns of competition j are codes[offset[j]] ~ codes[offset[j + 1] - 1],
+ * repeated patterns appear multiple times
+ */
+struct competitions {
+	std::vector<pattern::code> winner;
+	std::vector<pattern::code> codes;
+	std::vector<size_t> offset = { 0 };
+
+	size_t size() const { return winner.size(); }
+
+	void append(const competitions& c) {
+		for (size_t j = 0; j < c.size(); j++) {
+			winner.push_back(c.winner[j]);
+			codes.insert(codes.end(), c.codes.begin() + c.offset[j], c.codes.begin() + c.offset[j + 1]);
+			offset.push_back(codes.size());
+		}
+	}
+};
+
+/**
+ * replay a game and collect the competition of each move
+ */
+void extract(const std::vector<action>& moves, competitions& comp) {
+	board state;
+	for (const action& a : moves) {
+		action::place move(a);
+		board::piece_type who = move.color();
+		std::vector<pattern::code> legal;
+		bool found = false;
+		for (int i = 0; i < board::size_x * board::size_y; i++) {
+			board after = state;
+			if (after.place(board::point(i), who) != board::legal) continue;
+			pattern::code c = pattern::extract(state, i);
+			legal.push_back(who == board::black ? c : pattern::swap(c));
+			if (i == move.position().i) {
+				comp.winner.push_back(legal.back());
+				found = true;
+			}
+		}
+		if (!found || move.apply(state) != board::legal) break;
+		comp.codes.insert(comp.codes.end(), legal.begin(), legal.end());
+		comp.offset.push_back(comp.codes.size());
+	}
+}
+
+int main(int argc, const char* argv[]) {
+	std::cout << "HollowNoGo-MM: ";
+	std::copy(argv, argv + argc, std::ostream_iterator<const char*>(std::cout, " "));
+	std::cout << std::endl << std::endl;
+
+	std::vector<std::string> load_paths;
+	std::string save_path = "patterns.bin";
+	size_t iterations = 50;
+	size_t threads = std::max(1u, std::thread::hardware_concurrency());
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		auto match_arg = [&](std::string flag) -> bool {
+			auto it = arg.find_first_not_of('-');
+			return arg.find(flag, it) == it;
+		};
+		auto next_opt = [&]() -> std::string {
+			auto it = arg.find('=') + 1;
+			return it ? arg.substr(it) : argv[++i];
+		};
+		if (match_arg("load")) {
+			load_paths.push_back(next_opt());
+		} else if (match_arg("save")) {
+			save_path = next_opt();
+		} else if (match_arg("iterations")) {
+			iterations = std::stoull(next_opt());
+		} else if (match_arg("threads")) {
+			threads = std::max<size_t>(1, std::stoull(next_opt()));
+		}
+	}
+
+	statistics stats(0);
+	for (const std::string& load_path : load_paths) {
+		std::ifstream in(load_path, std::ios::in);
+		in >> stats;
+		in.close();
+	}
+
+	// extract the competitions of all games in parallel
+	std::vector<competitions> parts(threads);
+	std::vector<std::thread> workers;
+	for (size_t t = 0; t < threads; t++) {
+		workers.emplace_back([&, t]() {
+			for (size_t i = t; i < stats.size(); i += threads)
+				extract(stats.at(i).actions(), parts[t]);
+		});
+	}
+	for (std::thread& worker : workers) worker.join();
+	workers.clear();
+	competitions comp;
+	for (const competitions& part : parts) comp.append(part);
+	parts.clear();
+	std::cout << "games = " << stats.size() << ", moves = " << comp.size() << std::endl;
+	if (comp.size() == 0) return 1;
+
+	// the wins of each pattern, plus one virtual win against a virtual opponent of strength 1
+	std::vector<double> wins(pattern::size, 1.0);
+	for (pattern::code c : comp.winner) wins[c] += 1;
+
+	std::vector<double> gamma(pattern::size, 1.0);
+	for (size_t it = 1; it <= iterations; it++) {
+		// accumulate sum_j (C_ij / E_j) of every pattern i, each thread with its own buffer
+		std::vector<std::vector<double>> denom(threads, std::vector<double>(pattern::size, 0.0));
+		std::vector<double> loglik(threads, 0.0);
+		for (size_t t = 0; t < threads; t++) {
+			workers.emplace_back([&, t]() {
+				std::vector<double>& acc = denom[t];
+				for (size_t j = t; j < comp.size(); j += threads) {
+					double team = 0;
+					for (size_t k = comp.offset[j]; k < comp.offset[j + 1]; k++) team += gamma[comp.codes[k]];
+					for (size_t k = comp.offset[j]; k < comp.offset[j + 1]; k++) acc[comp.codes[k]] += 1.0 / team;
+					loglik[t] += std::log(gamma[comp.winner[j]] / team);
+				}
+			});
+		}
+		for (std::thread& worker : workers) worker.join();
+		workers.clear();
+
+		double ll = 0;
+		for (size_t t = 0; t < threads; t++) ll += loglik[t];
+		for (size_t i = 0; i < pattern::size; i++) {
+			double sum = 2.0 / (gamma[i] + 1.0); // one virtual win and one virtual loss
+			for (size_t t = 0; t < threads; t++) sum += denom[t][i];
+			gamma[i] = wins[i] / sum;
+		}
+		std::cout << it << "\t" << "loglik = " << (ll / comp.size()) << std::endl;
+	}
+
+	pattern_table table;
+	for (size_t i = 0; i < pattern::size; i++) table[i] = float(gamma[i]);
+	table.save(save_path);
+	std::cout << "save to " << save_path << std::endl;
+
+	return 0;
+}
@@ -11,11 +11,26 @@
 #include <fstream>
 #include <iterator>
 #include <string>
+#include <memory>
+#include <chrono>
 #include "board.h"
 #include "action.h"
 #include "agent.h"
 #include "episode.h"
 #include "statistics.h"
+#include "book.h"
+#include "trainer.h"
+#include "replay.h"
+#include "arena.h"
+#include "remote.h"
+#include "tournament.h"
+#include "sprt.h"
+#include "spsa.h"
+#include "perft.h"
+#include "suite.h"
+#include "histogram.h"
+#include "trace.h"
+#include "alloc.h"
 
 int main(int argc, const char* argv[]) {
 	std::cout << "HollowNoGo-Demo: ";
@@ -24,9 +39,30 @@ int main(int argc, const char* argv[]) {
 
 	size_t total = 20, block = 0, limit = 0;
 	std::string black_args, white_args;
-	std::string load_path, save_path;
+	std::vector<std::string> load_paths;
+	std::string save_path;
+	std::string book_path;
+	size_t book_depth = 10;
 	std::string name = "TCG-HollowNoGo-Demo", version = "2022"; // for GTP shell
 	bool shell = false;
+	bool train = false;
+	std::string train_args;
+	std::string selfplay_path;
+	size_t capacity = 100000;
+	size_t threads = 1;
+	std::string coordinator_address, worker_address;
+	size_t batch = 10;
+	std::string tournament_path;
+	bool match = false;
+	std::string sprt_args;
+	std::string spsa_params;
+	unsigned perft_depth = 0;
+	std::string position;
+	bool hashing = false;
+	std::string suite_path;
+	size_t budget_min = 100, budget_max = 6400;
+	bool profile = false;
+	std::string trace_path;
 	for (int i = 1; i < argc; i++) {
 		std::string arg = argv[i];
 		auto match_arg = [&](std::string flag) -> bool {
@@ -48,55 +84,161 @@ int main(int argc, const char* argv[]) {
 		} else if (match_arg("white")) {
 			white_args = next_opt();
 		} else if (match_arg("load")) {
-			load_path = next_opt();
+			load_paths.push_back(next_opt());
 		} else if (match_arg("save")) {
 			save_path = next_opt();
+		} else if (match_arg("build-book")) {
+			book_path = next_opt();
+		} else if (match_arg("book-depth")) {
+			book_depth = std::stoull(next_opt());
+		} else if (match_arg("selfplay")) {
+			selfplay_path = next_opt();
+		} else if (match_arg("capacity")) {
+			capacity = std::stoull(next_opt());
+		} else if (match_arg("threads")) {
+			threads = std::max<size_t>(1, std::stoull(next_opt()));
+		} else if (match_arg("coordinator")) {
+			coordinator_address = next_opt();
+		} else if (match_arg("worker")) {
+			worker_address = next_opt();
+		} else if (match_arg("batch")) {
+			batch = std::stoull(next_opt());
+		} else if (match_arg("tournament")) {
+			tournament_path = next_opt();
+		} else if (match_arg("sprt")) {
+			match = true;
+			if (arg.find('=') != std::string::npos) sprt_args = next_opt();
+		} else if (match_arg("spsa")) {
+			spsa_params = next_opt();
+		} else if (match_arg("perft")) {
+			perft_depth = std::stoul(next_opt());
+		} else if (match_arg("position")) {
+			position = next_opt();
+		} else if (match_arg("hash")) {
+			hashing = true;
+		} else if (match_arg("suite")) {
+			suite_path = next_opt();
+		} else if (match_arg("budget")) {
+			std::string budget = next_opt();
+			budget_min = std::stoull(budget);
+			if (budget.find(',') != std::string::npos) budget_max = std::stoull(budget.substr(budget.find(',') + 1));
+		} else if (match_arg("profile")) {
+			profile = true;
+		} else if (match_arg("trace")) {
+			trace_path = next_opt();
 		} else if (match_arg("name")) {
 			name = next_opt();
 		} else if (match_arg("version")) {
 			version = next_opt();
 		} else if (match_arg("shell")) {
 			shell = true;
+		} else if (match_arg("train")) {
+			train = true;
+			if (arg.find('=') != std::string::npos) train_args = next_opt();
 		}
 	}
 
+	if (trace_path.size()) tracer::instance().open(trace_path); // written at exit
+
+	if (train) { // train the n-tuple network by self-play
+		td_trainer trainer(train_args);
+		trainer.train(total, block);
+		return 0;
+	}
+
+	if (worker_address.size()) { // play the games handed out by a coordinator
+		worker remote(worker_address, threads);
+		remote.run();
+		return 0;
+	}
+
+	if (perft_depth) { // count the legal move sequences from the position, given as moves like ";B[ee];W[dc]"
+		board state;
+		std::stringstream moves(position);
+		for (action::place move; (moves >> std::ws).peek() != EOF; ) {
+			if (!(move << moves) || move.apply(state) != board::legal) {
+				std::cerr << "illegal move in position: " << position << std::endl;
+				return 1;
+			}
+		}
+		perft counter(threads, hashing);
+		counter.show(state, perft_depth);
+		return 0;
+	}
+
+	if (suite_path.size()) { // run the black player on the test suite
+		test_suite suite(suite_path);
+		suite.run(black_args, budget_min, budget_max);
+		return 0;
+	}
+
+	if (spsa_params.size()) { // tune the parameters of black for 'total' iterations of 'batch' games
+		spsa_tuner tuner(spsa_params, black_args, threads);
+		tuner.run(total, batch);
+		std::cout << "tuned: " << tuner.values() << std::endl;
+		return 0;
+	}
+
+	std::unique_ptr<tournament> league;
+	if (tournament_path.size()) { // play 'total' games for every pairing
+		league.reset(new tournament(tournament_path, threads));
+		total *= league->pairings();
+	} else if (match) { // play at most 'total' games between black (A) and white (B), swapping colors
+		league.reset(new tournament({ "name=A " + black_args, "name=B " + white_args }, threads));
+	}
+
 	statistics stats(total, block, limit);
 
-	if (load_path.size()) {
+	for (const std::string& load_path : load_paths) {
 		std::ifstream in(load_path, std::ios::in);
 		in >> stats;
 		in.close();
-		if (stats.is_finished()) stats.summary();
 	}
+	if (load_paths.size() && stats.is_finished()) stats.summary();
 
-	// player black("name=black " + black_args + " role=black");
-	// player white("name=white " + white_args + " role=white");
+	if (book_path.size()) { // build an opening book from the loaded statistics
+		book_builder builder(book_depth);
+		for (size_t i = 0; i < stats.size(); i++)
+			builder.add(stats.at(i).actions());
+		builder.save(book_path);
+		std::cout << "book: " << builder.size() << " entries from " << stats.size() << " games" << std::endl;
+		return 0;
+	}
 
-	MCTSplayer black("name=black " + black_args + " role=black");
-	MCTSplayer white("name=white " + white_args + " role=white");
+	sprt test(sprt_args);
+	if (match) { // stop as soon as either hypothesis is accepted
+		stats.listen([&](const episode& game) {
+			test.update(game.winner() == league->name(0));
+			test.show();
+			if (test.status()) stats.finish();
+		});
+	}
 
-	if (!shell) { // launch standard local games
-		while (!stats.is_finished()) {
-//			std::cerr << "======== Game " << stats.step() << " ========" << std::endl;
-			black.open_episode("~:" + white.name());
-			white.open_episode(black.name() + ":~");
+	replay_buffer replay;
+	if (selfplay_path.size()) replay.open(selfplay_path, capacity);
 
-			stats.open_episode(black.name() + ":" + white.name());
-			episode& game = stats.back();
-			while (true) {
-				agent& who = game.take_turns(black, white);
-				action move = who.take_action(game.state());
-//				std::cerr << game.state() << "#" << game.step() << " " << who.name() << ": " << move << std::endl;
-				if (game.apply_action(move) != true) break;
-				if (who.check_for_win(game.state())) break;
-			}
-			agent& win = game.last_turns(black, white);
-			stats.close_episode(win.name());
-			std::cout<<win.name()<<std::endl;
-			black.close_episode(win.name());
-			white.close_episode(win.name());
-		}
+	if (league) { // launch a round-robin tournament, or an A/B match
+		league->run(stats);
+		league->report();
+	} else if (coordinator_address.size()) { // hand out the games to workers
+		coordinator remote(coordinator_address, black_args, white_args, batch);
+		remote.run(stats);
+	} else if (!shell) { // launch standard local games
+		arena games(black_args, white_args, threads);
+		games.run(stats, replay.capacity() ? &replay : nullptr);
 	} else { // launch GTP shell
+		// player black("name=black " + black_args + " role=black");
+		// player white("name=white " + white_args + " role=white");
+
+		std::unique_ptr<agent> black_player(create_player("name=black " + black_args + " role=black"));
+		std::unique_ptr<agent> white_player(create_player("name=white " + white_args + " role=white"));
+		agent& black = *black_player;
+		agent& white = *white_player;
+		latency_histogram latency, searches; // of genmove, in nanoseconds and in playouts
+		auto report = [&]() -> std::string {
+			return "latency (ms): " + latency.summary(1e6) + "\n" + "playouts: " + searches.summary();
+		};
+
 		for (std::string command; std::getline(std::cin, command); ) {
 			if (command.back() == '\r') command.pop_back();
 			if (command.empty()) continue;
@@ -147,7 +289,11 @@ int main(int argc, const char* argv[]) {
 						break;
 					}
 				} else if (args[0] == "genmove") { // generate a move and play
+					auto start = std::chrono::steady_clock::now();
 					action::place move = who.take_action(game.state());
+					latency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+					MCTSplayer* search = dynamic_cast<MCTSplayer*>(&who);
+					if (search && search->telemetry().iterations) searches.record(search->telemetry().iterations); // not for book moves
 					if (game.apply_action(move) == true) {
 						reply = move.position();
 					} else { // I have no legal move to play
@@ -162,7 +308,10 @@ int main(int argc, const char* argv[]) {
 					black.close_episode(win.name());
 					white.close_episode(win.name());
 				}
-				if (args[0] == "quit") break; // quit GTP shell
+				if (args[0] == "quit") { // quit GTP shell
+					std::cerr << report() << std::endl;
+					break;
+				}
 
 			} else if (args[0] == "showboard") { // print the board
 				std::stringstream buf;
@@ -183,9 +332,11 @@ int main(int argc, const char* argv[]) {
 				reply = version;
 			} else if (args[0] == "protocol_version") { // report GTP protocol version
 				reply = "2";
+			} else if (args[0] == "latency") { // report the percentiles of genmove latency and playouts
+				reply = report();
 			} else if (args[0] == "list_commands") { // print supported commands
 				reply = "play\n" "genmove\n" "clear_board\n" "showboard\n" "boardsize\n"
-				        "name\n" "version\n" "protocol_version\n" "list_commands\n" "quit\n";
+				        "name\n" "version\n" "protocol_version\n" "latency\n" "list_commands\n" "quit\n";
 			} else {
 				reply = "unknown command";
 			}
@@ -194,6 +345,9 @@ int main(int argc, const char* argv[]) {
 		}
 	}
 
+	if (profile) stats.profile(stats.size()); // the thinking time of every ply
+	if (alloc_tracker::enabled) alloc_tracker::show(); // the allocations and memory usage, by 'make alloc'
+
 	if (save_path.size()) {
 		std::ofstream out(save_path, std::ios::out | std::ios::trunc);
 		out << stats;
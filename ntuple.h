@@ -0,0 +1,246 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * ntuple.h: N-tuple network for evaluating NoGo positions
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <array>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <cstdint>
+#include "board.h"
+
+/**
+ * the scale between stored weights and values
+ * float tables store values directly, int16 tables store values in 1/4096
+ */
+template<typename weight_type> struct ntuple_weight {
+	static constexpr float scale = 1.0f;
+	static weight_type quantize(float v) { return v; }
+};
+template<> struct ntuple_weight<int16_t> {
+	static constexpr float scale = 1.0f / 4096;
+	static int16_t quantize(float v) {
+		return int16_t(std::max(-32768.0f, std::min(32767.0f, std::round(v / scale))));
+	}
+};
+
+/**
+ * n-tuple network over the 81 points
+ *
+ * each tuple shape is shared by its 8 symmetric images (rotations and reflections),
+ * each point of a tuple is one of { empty = 0, own = 1, opponent = 2, hollow = 3 },
+ * where 'own' is the player to move, so one table serves both colors
+ *
+ * all features are padded to the same length with a dummy point that is always empty,
+ * so the lookup is a fixed-stride gather that the compiler can unroll and vectorize
+ *
+ * the value is the expected outcome for the player to move, +1 for a win and -1 for a loss
+ */
+template<typename weight_type = float>
+class ntuple_network {
+public:
+	static constexpr uint64_t magic = 0x314e544e4f474f4eull; // "NOGONTN1"
+	enum { points = board::size_x * board::size_y, dummy = points, symmetries = 8 };
+	typedef std::array<uint8_t, points + 1> cells;
+
+	ntuple_network(const std::string& shapes = default_shapes()) { init(shapes); }
+
+public:
+	/**
+	 * initialize zero weights for the given tuple shapes,
+	 * e.g., "A1,B1,C1,A2,B2,C2/D4,E4,F4" defines a 2x3 tuple and a 1x3 tuple
+	 */
+	void init(const std::string& shapes) {
+		std::vector<std::vector<int>> tuples;
+		std::stringstream ss(shapes);
+		for (std::string tuple; std::getline(ss, tuple, '/'); ) {
+			std::stringstream ts(tuple);
+			tuples.emplace_back();
+			for (std::string name; std::getline(ts, name, ','); ) {
+				board::point p(name);
+				if (p.i < 0 || p.i >= points) throw std::invalid_argument("invalid tuple point: " + name);
+				tuples.back().push_back(p.i);
+			}
+		}
+		init(tuples);
+	}
+
+	void init(const std::vector<std::vector<int>>& tuples) {
+		shape = tuples;
+		length = 0;
+		for (const std::vector<int>& tuple : shape) {
+			if (tuple.empty() || tuple.size() > 12) throw std::invalid_argument("invalid tuple length");
+			for (int p : tuple)
+				if (p < 0 || p >= points) throw std::invalid_argument("invalid tuple point");
+			length = std::max(length, tuple.size());
+		}
+		table.clear();
+		feature.clear();
+		size_t size = 0;
+		for (const std::vector<int>& tuple : shape) {
+			for (int s = 0; s < symmetries; s++) {
+				table.push_back(size);
+				for (size_t k = 0; k < length; k++)
+					feature.push_back(k < tuple.size() ? board::symmetry(s)[tuple[k]] : int(dummy));
+			}
+			size += size_t(1) << (2 * tuple.size());
+		}
+		weight.assign(size, weight_type(0));
+	}
+
+	size_t size() const { return weight.size(); }
+	size_t features() const { return table.size(); }
+	weight_type& operator [](size_t i) { return weight[i]; }
+	const weight_type& operator [](size_t i) const { return weight[i]; }
+
+public:
+	/**
+	 * encode a board from the view of the player to move
+	 */
+	static cells encode(const board& b) {
+		cells c;
+		unsigned own = b.info().who_take_turns;
+		for (int i = 0; i < points; i++) {
+			unsigned cell = b(i);
+			c[i] = (cell == board::empty || cell == board::hollow) ? cell : (cell == own ? 1 : 2);
+		}
+		c[dummy] = 0;
+		return c;
+	}
+
+	/**
+	 * the table index of the f-th feature
+	 */
+	size_t index(const cells& c, size_t f) const {
+		const int* p = &feature[f * length];
+		size_t idx = 0;
+		for (size_t k = 0; k < length; k++) idx |= size_t(c[p[k]]) << (2 * k);
+		return table[f] + idx;
+	}
+
+	float estimate(const cells& c) const {
+		int32_t sum = 0;
+		float fsum = 0;
+		for (size_t f = 0; f < table.size(); f++) {
+			if (std::is_integral<weight_type>::value) sum += weight[index(c, f)];
+			else fsum += weight[index(c, f)];
+		}
+		return std::is_integral<weight_type>::value ? sum * ntuple_weight<weight_type>::scale : fsum;
+	}
+	float estimate(const board& b) const { return estimate(encode(b)); }
+
+	/**
+	 * the winning probability of the player to move
+	 */
+	float evaluate(const board& b) const {
+		return std::max(0.0f, std::min(1.0f, (estimate(b) + 1) / 2));
+	}
+
+	/**
+	 * add 'u' to every weight involved in the given position
+	 */
+	void update(const cells& c, float u) {
+		for (size_t f = 0; f < table.size(); f++) {
+			weight_type& w = weight[index(c, f)];
+			w = ntuple_weight<weight_type>::quantize(w * ntuple_weight<weight_type>::scale + u);
+		}
+	}
+	void update(const board& b, float u) { update(encode(b), u); }
+
+public:
+	/**
+	 * the binary format is
+	 *   magic, sizeof(weight_type), number of tuples,
+	 *   length and points of each tuple, and then the weights
+	 * weights of another type are converted when loading
+	 */
+	void save(const std::string& path) const {
+		std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+		uint64_t head = magic;
+		uint32_t type = sizeof(weight_type), count = shape.size();
+		out.write(reinterpret_cast<const char*>(&head), sizeof(head));
+		out.write(reinterpret_cast<const char*>(&type), sizeof(type));
+		out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+		for (const std::vector<int>& tuple : shape) {
+			uint32_t len = tuple.size();
+			out.write(reinterpret_cast<const char*>(&len), sizeof(len));
+			for (uint32_t p : tuple) out.write(reinterpret_cast<const char*>(&p), sizeof(p));
+		}
+		out.write(reinterpret_cast<const char*>(weight.data()), weight.size() * sizeof(weight_type));
+		if (!out) throw std::runtime_error("cannot write n-tuple network: " + path);
+	}
+
+	void load(const std::string& path) {
+		std::ifstream in(path, std::ios::in | std::ios::binary);
+		uint64_t head = 0;
+		uint32_t type = 0, count = 0;
+		in.read(reinterpret_cast<char*>(&head), sizeof(head));
+		in.read(reinterpret_cast<char*>(&type), sizeof(type));
+		in.read(reinterpret_cast<char*>(&count), sizeof(count));
+		if (!in || head != magic || (type != sizeof(float) && type != sizeof(int16_t)))
+			throw std::runtime_error("invalid n-tuple network: " + path);
+		std::vector<std::vector<int>> tuples(count);
+		for (std::vector<int>& tuple : tuples) {
+			uint32_t len = 0;
+			in.read(reinterpret_cast<char*>(&len), sizeof(len));
+			tuple.resize(std::min<uint32_t>(len, 64));
+			for (int& p : tuple) {
+				uint32_t v = 0;
+				in.read(reinterpret_cast<char*>(&v), sizeof(v));
+				p = v;
+			}
+		}
+		if (!in) throw std::runtime_error("invalid n-tuple network: " + path);
+		init(tuples);
+		if (type == sizeof(weight_type)) {
+			in.read(reinterpret_cast<char*>(weight.data()), weight.size() * sizeof(weight_type));
+		} else if (type == sizeof(float)) {
+			std::vector<float> raw(weight.size());
+			in.read(reinterpret_cast<char*>(raw.data()), raw.size() * sizeof(float));
+			for (size_t i = 0; i < raw.size(); i++) weight[i] = ntuple_weight<weight_type>::quantize(raw[i]);
+		} else {
+			std::vector<int16_t> raw(weight.size());
+			in.read(reinterpret_cast<char*>(raw.data()), raw.size() * sizeof(int16_t));
+			for (size_t i = 0; i < raw.size(); i++)
+				weight[i] = ntuple_weight<weight_type>::quantize(raw[i] * ntuple_weight<int16_t>::scale);
+		}
+		if (!in) throw std::runtime_error("truncated n-tuple network: " + path);
+	}
+
+public:
+	/**
+	 * 3x3 tuples at the corner, the edges and the center
+	 */
+	static std::string default_shapes() {
+		std::string shapes;
+		for (std::string corner : { "A1", "B2", "C1", "D1", "A4", "D4" }) {
+			board::point p(corner);
+			if (shapes.size()) shapes += '/';
+			for (int y = 0; y < 3; y++) {
+				for (int x = 0; x < 3; x++) {
+					shapes += std::string(board::point(p.x + x, p.y + y));
+					shapes += (x == 2 && y == 2) ? "" : ",";
+				}
+			}
+		}
+		return shapes;
+	}
+
+private:
+	std::vector<std::vector<int>> shape;
+	size_t length;
+	std::vector<size_t> table; // the table offset of each feature
+	std::vector<int> feature; // the points of each feature, 'length' per feature
+	std::vector<weight_type> weight;
+};
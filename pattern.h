@@ -0,0 +1,242 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * pattern.h: 3x3 patterns and the pattern-based rollout policy
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <array>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <random>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include "board.h"
+
+/**
+ * the 3x3 neighborhood of an empty point, encoded as 8 cells of 2 bits
+ *
+ * the neighbors are ordered as (slot 0 ~ 7)
+ *   0 1 2
+ *   3 . 4
+ *   5 6 7
+ * and each cell is one of { empty = 0, black = 1, white = 2, hollow or edge = 3 }
+ *
+ * codes are stored from the view of black, use pattern::swap() to get the view of white
+ */
+class pattern {
+public:
+	typedef uint16_t code;
+	enum { size = 1u << 16 };
+
+	/**
+	 * the point index of the neighbor at each slot, or -1 if out of the board
+	 */
+	typedef std::array<std::array<int, 8>, board::size_x * board::size_y> neighbor_table;
+	static const neighbor_table& neighbors() {
+		static neighbor_table table = []() {
+			neighbor_table table;
+			const int dx[] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+			const int dy[] = { 1, 1, 1, 0, 0, -1, -1, -1 };
+			for (int i = 0; i < board::size_x * board::size_y; i++) {
+				board::point p(i);
+				for (int k = 0; k < 8; k++) {
+					int x = p.x + dx[k], y = p.y + dy[k];
+					bool inside = x >= 0 && x < board::size_x && y >= 0 && y < board::size_y;
+					table[i][k] = inside ? board::point(x, y).i : -1;
+				}
+			}
+			return table;
+		}();
+		return table;
+	}
+
+	/**
+	 * the slot of a point as seen from its neighbor at slot k
+	 */
+	static int opposite(int k) { return 7 - k; }
+
+	/**
+	 * encode the neighborhood of point i from scratch
+	 */
+	static code extract(const board& b, int i) {
+		code c = 0;
+		for (int k = 0; k < 8; k++) {
+			int n = neighbors()[i][k];
+			unsigned cell = n != -1 ? b(n) : board::hollow;
+			c |= code((cell & 3u) << (2 * k));
+		}
+		return c;
+	}
+
+	/**
+	 * exchange black and white in a code
+	 */
+	static code swap(code c) {
+		static std::vector<code> table = []() {
+			std::vector<code> table(size);
+			for (unsigned c = 0; c < size; c++) {
+				unsigned s = 0;
+				for (int k = 0; k < 8; k++) {
+					unsigned cell = (c >> (2 * k)) & 3u;
+					if (cell == board::black || cell == board::white) cell = 3u - cell;
+					s |= cell << (2 * k);
+				}
+				table[c] = code(s);
+			}
+			return table;
+		}();
+		return table[c];
+	}
+};
+
+/**
+ * weights of 3x3 patterns, indexed by codes from the view of the player to move
+ *
+ * the binary format is an 8-byte magic followed by pattern::size floats
+ */
+class pattern_table {
+public:
+	static constexpr uint64_t magic = 0x315441504f474f4eull; // "NOGOPAT1"
+
+	pattern_table() : weights(pattern::size) { init(); }
+	pattern_table(const std::string& path) : pattern_table() { load(path); }
+
+public:
+	float& operator [](pattern::code c) { return weights[c]; }
+	const float& operator [](pattern::code c) const { return weights[c]; }
+	size_t size() const { return weights.size(); }
+
+	/**
+	 * the default weights: uniform, except that filling one's own eye is discouraged
+	 * since such points can never be taken by the opponent
+	 */
+	void init() {
+		for (unsigned c = 0; c < pattern::size; c++) {
+			bool eye = true;
+			for (int k : { 1, 3, 4, 6 }) {
+				unsigned cell = (c >> (2 * k)) & 3u;
+				eye &= (cell == board::black || cell == board::hollow);
+			}
+			weights[c] = eye ? 0.05f : 1.0f;
+		}
+	}
+
+	void load(const std::string& path) {
+		std::ifstream in(path, std::ios::in | std::ios::binary);
+		uint64_t head = 0;
+		in.read(reinterpret_cast<char*>(&head), sizeof(head));
+		if (!in || head != magic) throw std::runtime_error("invalid pattern table: " + path);
+		in.read(reinterpret_cast<char*>(weights.data()), weights.size() * sizeof(float));
+		if (!in) throw std::runtime_error("truncated pattern table: " + path);
+	}
+
+	void save(const std::string& path) const {
+		std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+		uint64_t head = magic;
+		out.write(reinterpret_cast<const char*>(&head), sizeof(head));
+		out.write(reinterpret_cast<const char*>(weights.data()), weights.size() * sizeof(float));
+		if (!out) throw std::runtime_error("cannot write pattern table: " + path);
+	}
+
+private:
+	std::vector<float> weights;
+};
+
+/**
+ * rollout policy that samples moves proportionally to their pattern weights
+ *
+ * the codes of all points are maintained incrementally as stones are placed,
+ * so a move only costs a weighted scan over the empty points plus the legality test
+ */
+class pattern_rollout {
+public:
+	pattern_rollout(const pattern_table& table) : table(table) {}
+
+public:
+	/**
+	 * play random moves from the given state until the player to move has no legal move
+	 * return the loser, i.e., the player to move at the end
+	 */
+	template<typename engine_type>
+	board::piece_type run(const board& state, engine_type& engine) {
+		reset(state);
+		board::piece_type who = state.info().who_take_turns;
+		std::array<float, board::size_x * board::size_y> weight;
+		while (true) {
+			float total = 0;
+			for (size_t j = 0; j < empties.size(); j++) {
+				pattern::code c = codes[empties[j]];
+				weight[j] = table[who == board::black ? c : pattern::swap(c)];
+				total += weight[j];
+			}
+			bool moved = false;
+			while (total > 0 && !moved) {
+				float r = std::uniform_real_distribution<float>(0, total)(engine);
+				size_t j = 0;
+				for (; j + 1 < empties.size() && (r >= weight[j] || weight[j] <= 0); j++) r -= std::max(weight[j], 0.0f);
+				if (weight[j] <= 0) break; // rounding left no candidate
+				if (current.place(board::point(empties[j]), who) == board::legal) {
+					play(j, who);
+					moved = true;
+				} else {
+					total -= weight[j];
+					weight[j] = -1; // tested, illegal
+				}
+			}
+			if (!moved && !fallback(who, weight)) return who;
+			who = static_cast<board::piece_type>(3u - who);
+		}
+	}
+
+private:
+	void reset(const board& state) {
+		current = state;
+		empties.clear();
+		for (int i = 0; i < board::size_x * board::size_y; i++) {
+			codes[i] = pattern::extract(state, i);
+			if (state(i) == board::empty) empties.push_back(i);
+		}
+	}
+
+	/**
+	 * update the codes of the neighbors of the j-th empty point, then remove it
+	 */
+	void play(size_t j, board::piece_type who) {
+		int i = empties[j];
+		for (int k = 0; k < 8; k++) {
+			int n = pattern::neighbors()[i][k];
+			if (n == -1) continue;
+			int shift = 2 * pattern::opposite(k);
+			codes[n] = pattern::code((codes[n] & ~(3u << shift)) | (unsigned(who) << shift));
+		}
+		empties[j] = empties.back();
+		empties.pop_back();
+	}
+
+	/**
+	 * try the untested points, so that a zero weight never ends the game early
+	 */
+	template<typename weight_list>
+	bool fallback(board::piece_type who, const weight_list& weight) {
+		for (size_t j = 0; j < empties.size(); j++) {
+			if (weight[j] < 0) continue;
+			if (current.place(board::point(empties[j]), who) == board::legal) {
+				play(j, who);
+				return true;
+			}
+		}
+		return false;
+	}
+
+private:
+	const pattern_table& table;
+	board current;
+	std::vector<int> empties;
+	std::array<pattern::code, board::size_x * board::size_y> codes;
+};
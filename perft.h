@@ -0,0 +1,126 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * perft.h: Count legal move sequences for validating and timing the move generation
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <cstdint>
+#include "board.h"
+
+/**
+ * count the legal move sequences of a given length from a position
+ *
+ * the root moves are counted in parallel by 'threads' workers,
+ * and with 'hashing', each worker memoizes the counts of the positions it has seen by board::hash,
+ * so positions reached by different move orders are expanded only once
+ */
+class perft {
+public:
+	perft(size_t threads = 1, bool hashing = false) : threads(std::max<size_t>(1, threads)), hashing(hashing), visited(0), placed(0) {}
+
+public:
+	/**
+	 * the number of legal move sequences of length 'depth' from 'state'
+	 */
+	uint64_t count(const board& state, unsigned depth) {
+		visited = 0;
+		placed = 0;
+		if (depth == 0) return 1;
+		std::vector<board> roots = children(state);
+		visited = 1;
+		placed = roots.size();
+		if (depth == 1) return roots.size();
+
+		std::atomic<size_t> next(0);
+		std::atomic<uint64_t> total(0);
+		std::vector<std::thread> workers;
+		for (size_t t = 0; t < threads; t++) {
+			workers.emplace_back([&]() {
+				std::vector<std::unordered_map<uint64_t, uint64_t>> memo(depth);
+				uint64_t sum = 0, nodes = 0, moves = 0;
+				for (size_t k; (k = next++) < roots.size(); )
+					sum += count(roots[k], depth - 1, memo, nodes, moves);
+				total += sum;
+				visited += nodes;
+				placed += moves;
+			});
+		}
+		for (std::thread& worker : workers) worker.join();
+		return total;
+	}
+
+	/**
+	 * the number of positions actually expanded by the last count, i.e., excluding memoized ones
+	 */
+	uint64_t expanded() const { return visited; }
+
+	/**
+	 * the legal positions generated by the last count, which equals the sum of the counts of every depth without hashing
+	 */
+	uint64_t generated() const { return placed; }
+
+	/**
+	 * show the counts from depth 1 to 'depth'
+	 *
+	 * the format is
+	 * 3      count = 373160, expanded = 5330, generated = 378489, time = 0.052 s, nps = 7278634
+	 *
+	 * where 'nps' is the generated positions per second, i.e., the speed of the move generation,
+	 * which differs from the count per second when hashing
+	 */
+	void show(const board& state, unsigned depth, std::ostream& out = std::cout) {
+		for (unsigned d = 1; d <= depth; d++) {
+			auto start = std::chrono::steady_clock::now();
+			uint64_t n = count(state, d);
+			double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			out << d << "\t" << "count = " << n << ", expanded = " << expanded() << ", generated = " << generated() << ", ";
+			out << "time = " << elapsed << " s, nps = " << uint64_t(generated() / std::max(elapsed, 1e-9)) << std::endl;
+		}
+	}
+
+private:
+	static std::vector<board> children(const board& state) {
+		std::vector<board> next;
+		for (int i = 0; i < board::size_x * board::size_y; i++) {
+			board after = state;
+			if (after.place(board::point(i)) == board::legal) next.push_back(after);
+		}
+		return next;
+	}
+
+	uint64_t count(const board& state, unsigned depth, std::vector<std::unordered_map<uint64_t, uint64_t>>& memo, uint64_t& nodes, uint64_t& moves) {
+		uint64_t key = 0;
+		if (hashing && depth > 1) {
+			key = state.hash();
+			auto it = memo[depth].find(key);
+			if (it != memo[depth].end()) return it->second;
+		}
+		nodes++;
+		uint64_t sum = 0;
+		for (int i = 0; i < board::size_x * board::size_y; i++) {
+			board after = state;
+			if (after.place(board::point(i)) != board::legal) continue;
+			moves++;
+			sum += depth > 1 ? count(after, depth - 1, memo, nodes, moves) : 1;
+		}
+		if (hashing && depth > 1) memo[depth][key] = sum;
+		return sum;
+	}
+
+private:
+	size_t threads;
+	bool hashing;
+	std::atomic<uint64_t> visited;
+	std::atomic<uint64_t> placed;
+};
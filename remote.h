@@ -0,0 +1,310 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * remote.h: Distributed self-play with a coordinator and worker processes
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <string>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "episode.h"
+#include "statistics.h"
+#include "arena.h"
+
+/**
+ * line-based stream over a socket
+ *
+ * the address is either a path of a Unix domain socket, e.g., "/tmp/nogo.sock",
+ * or "host:port" for TCP, so workers may run on other machines
+ */
+class remote_link {
+public:
+	remote_link(int fd = -1) : fd(fd) {}
+	remote_link(const remote_link&) = delete;
+	remote_link& operator =(const remote_link&) = delete;
+	~remote_link() { close(); }
+
+public:
+	static bool is_tcp(const std::string& address) {
+		return address.find('/') == std::string::npos && address.find(':') != std::string::npos;
+	}
+
+	/**
+	 * create a listening socket at the given address
+	 */
+	static int listen(const std::string& address) {
+		int fd = -1;
+		if (is_tcp(address)) {
+			addrinfo* info = resolve(address, true);
+			fd = socket(info->ai_family, SOCK_STREAM, 0);
+			int on = 1;
+			setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+			if (fd == -1 || bind(fd, info->ai_addr, info->ai_addrlen) == -1) fd = fail(fd, info, address);
+			freeaddrinfo(info);
+		} else {
+			sockaddr_un addr = unix_address(address);
+			unlink(address.c_str());
+			fd = socket(AF_UNIX, SOCK_STREAM, 0);
+			if (fd == -1 || bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1) fd = fail(fd, nullptr, address);
+		}
+		if (::listen(fd, 64) == -1) fail(fd, nullptr, address);
+		return fd;
+	}
+
+	void connect(const std::string& address) {
+		close();
+		if (is_tcp(address)) {
+			addrinfo* info = resolve(address, false);
+			fd = socket(info->ai_family, SOCK_STREAM, 0);
+			if (fd == -1 || ::connect(fd, info->ai_addr, info->ai_addrlen) == -1) fd = fail(fd, info, address);
+			freeaddrinfo(info);
+		} else {
+			sockaddr_un addr = unix_address(address);
+			fd = socket(AF_UNIX, SOCK_STREAM, 0);
+			if (fd == -1 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1) fd = fail(fd, nullptr, address);
+		}
+	}
+
+	void close() {
+		if (fd != -1) ::close(fd);
+		fd = -1;
+	}
+
+	int handle() const { return fd; }
+
+	bool send(const std::string& line) {
+		std::string data = line + '\n';
+		for (size_t sent = 0; sent < data.size(); ) {
+			ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+			if (n <= 0 && errno != EINTR) return false;
+			if (n > 0) sent += n;
+		}
+		return true;
+	}
+
+	/**
+	 * read what is available (blocking if 'wait'), and move the complete lines into 'lines'
+	 * return false if the connection is closed
+	 */
+	bool receive(std::vector<std::string>& lines, bool wait = true) {
+		char chunk[65536];
+		ssize_t n;
+		do {
+			n = ::recv(fd, chunk, sizeof(chunk), wait ? 0 : MSG_DONTWAIT);
+		} while (n < 0 && errno == EINTR);
+		if (n <= 0) return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+		buffer.append(chunk, n);
+		for (size_t end; (end = buffer.find('\n')) != std::string::npos; buffer.erase(0, end + 1))
+			lines.push_back(buffer.substr(0, end));
+		return true;
+	}
+
+	/**
+	 * block until a complete line is received
+	 */
+	bool receive_line(std::string& line) {
+		std::vector<std::string> lines;
+		while (pending.empty()) {
+			if (!receive(lines)) return false;
+			pending.insert(pending.end(), lines.begin(), lines.end());
+			lines.clear();
+		}
+		line = pending.front();
+		pending.erase(pending.begin());
+		return true;
+	}
+
+private:
+	static sockaddr_un unix_address(const std::string& path) {
+		sockaddr_un addr;
+		std::memset(&addr, 0, sizeof(addr));
+		addr.sun_family = AF_UNIX;
+		if (path.size() >= sizeof(addr.sun_path)) throw std::invalid_argument("socket path too long: " + path);
+		std::strcpy(addr.sun_path, path.c_str());
+		return addr;
+	}
+
+	static addrinfo* resolve(const std::string& address, bool passive) {
+		std::string host = address.substr(0, address.rfind(':'));
+		std::string port = address.substr(address.rfind(':') + 1);
+		addrinfo hints, *info = nullptr;
+		std::memset(&hints, 0, sizeof(hints));
+		hints.ai_family = AF_UNSPEC;
+		hints.ai_socktype = SOCK_STREAM;
+		hints.ai_flags = passive ? AI_PASSIVE : 0;
+		if (getaddrinfo(host.size() ? host.c_str() : nullptr, port.c_str(), &hints, &info) != 0 || !info)
+			throw std::runtime_error("cannot resolve address: " + address);
+		return info;
+	}
+
+	static int fail(int fd, addrinfo* info, const std::string& address) {
+		std::string reason = std::strerror(errno);
+		if (fd != -1) ::close(fd);
+		if (info) freeaddrinfo(info);
+		throw std::runtime_error("cannot use address " + address + ": " + reason);
+	}
+
+private:
+	int fd;
+	std::string buffer;
+	std::vector<std::string> pending;
+};
+
+/**
+ * hand out batches of games to workers and collect the episodes into the statistics
+ *
+ * the protocol is line-based text, so workers of different builds can join:
+ *   worker: "ready"
+ *   coordinator: "play <games>", "black <args>", "white <args>", or "done" if no game is left
+ *   worker: "episode <sgf>" for every game, and then "ready" again
+ * games of a disconnected worker are handed out again
+ */
+class coordinator {
+public:
+	coordinator(const std::string& address, const std::string& black_args, const std::string& white_args, size_t batch = 10)
+		: address(address), black_args(black_args), white_args(white_args), batch(std::max<size_t>(1, batch)),
+		  batches(0), total(0), assigned(0), received(0) {}
+
+public:
+	void run(statistics& stats, std::ostream& out = std::cout) {
+		int server = remote_link::listen(address);
+		std::cerr << "coordinator listening at " << address << std::endl;
+		total = stats.is_finished() ? 0 : stats.total_episodes() - stats.step();
+		assigned = received = 0;
+
+		while (received < total || peers.size()) {
+			std::vector<pollfd> fds = { { server, POLLIN, 0 } };
+			for (const auto& peer : peers) fds.push_back({ peer.first, POLLIN, 0 });
+			if (poll(fds.data(), fds.size(), 1000) < 0 && errno != EINTR) break;
+
+			if (fds[0].revents & POLLIN) {
+				int fd = accept(server, nullptr, nullptr);
+				if (fd != -1) peers[fd].link.reset(new remote_link(fd));
+			}
+			for (size_t k = 1; k < fds.size(); k++) {
+				if (!(fds[k].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+				int fd = fds[k].fd;
+				peer& who = peers[fd];
+				std::vector<std::string> lines;
+				bool alive = who.link->receive(lines, false);
+				for (const std::string& line : lines) {
+					if (line.find("episode ") == 0 && who.owed) {
+						episode ep;
+						std::stringstream(line.substr(8)) >> ep;
+						out << ep.winner() << '\n';
+						stats.append(std::move(ep));
+						who.owed--;
+						received++;
+					} else if (line == "ready") {
+						assigned -= who.owed; // anything not delivered is handed out again
+						who.owed = 0;
+						who.idle = true;
+					}
+				}
+				out.flush();
+				if (!alive) drop(fd);
+			}
+			for (auto it = peers.begin(); it != peers.end(); ) { // hand out the games to the idle workers
+				int fd = (it++)->first;
+				if (peers[fd].idle && !dispatch(peers[fd])) drop(fd);
+			}
+		}
+		::close(server);
+		if (!remote_link::is_tcp(address)) unlink(address.c_str());
+	}
+
+private:
+	struct peer {
+		std::unique_ptr<remote_link> link;
+		size_t owed = 0; // the games assigned but not received yet
+		bool idle = false;
+	};
+
+	/**
+	 * send a batch to an idle worker, or dismiss it if all games are finished
+	 * return false if the worker should be dropped
+	 */
+	bool dispatch(peer& who) {
+		size_t n = std::min(batch, total - std::min(total, assigned));
+		if (n) {
+			who.idle = false;
+			who.owed = n;
+			assigned += n;
+			batches++; // every batch plays with its own seeds
+			return who.link->send("play " + std::to_string(n))
+			    && who.link->send("black " + seed_args(black_args, batches * 2))
+			    && who.link->send("white " + seed_args(white_args, batches * 2 + 1));
+		} else if (received >= total) {
+			who.link->send("done");
+			return false;
+		}
+		return true;
+	}
+
+	void drop(int fd) {
+		assigned -= peers[fd].owed;
+		peers.erase(fd);
+	}
+
+private:
+	std::string address;
+	std::string black_args;
+	std::string white_args;
+	size_t batch;
+	size_t batches;
+	size_t total;
+	size_t assigned;
+	size_t received;
+	std::map<int, peer> peers;
+};
+
+/**
+ * connect to a coordinator, play the batches it hands out with local threads, and send back the episodes
+ */
+class worker {
+public:
+	worker(const std::string& address, size_t threads = 1) : address(address), threads(threads) {}
+
+public:
+	void run() {
+		remote_link link;
+		link.connect(address);
+		for (std::string line; link.send("ready") && link.receive_line(line); ) {
+			if (line.find("play ") != 0) break; // done
+			size_t n = std::stoull(line.substr(5));
+			std::string black_line, white_line;
+			if (!link.receive_line(black_line) || !link.receive_line(white_line)) break;
+			std::string black_args = black_line.substr(black_line.find(' ') + 1);
+			std::string white_args = white_line.substr(white_line.find(' ') + 1);
+
+			statistics stats(n); // shows the summary of the batch when finished
+			arena games(black_args, white_args, threads);
+			std::stringstream silent;
+			games.run(stats, nullptr, silent);
+			for (size_t i = 0; i < stats.size(); i++) {
+				std::stringstream sgf;
+				sgf << stats.at(i);
+				if (!link.send("episode " + sgf.str())) return;
+			}
+		}
+	}
+
+private:
+	std::string address;
+	size_t threads;
+};
@@ -0,0 +1,169 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * replay.h: Memory-mapped replay buffer of self-play training data
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <array>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "board.h"
+
+/**
+ * fixed-size record of a position
+ *
+ *  'stone' is the board cells indexed by the 1-d index, see board::point
+ *  'who' is the player to move
+ *  'result' is +1 if the player to move won the game, -1 otherwise
+ *  'policy' is the root visit distribution of the search, over the 1-d indices
+ */
+struct replay_record {
+	enum { points = board::size_x * board::size_y };
+	uint8_t stone[points];
+	uint8_t who;
+	int8_t result;
+	uint8_t reserved[1];
+	float policy[points];
+
+	board state() const {
+		board b;
+		for (int i = 0; i < points; i++) b(i) = stone[i];
+		b.info({ static_cast<board::piece_type>(who) });
+		return b;
+	}
+
+	void assign(const board& b) {
+		for (int i = 0; i < points; i++) stone[i] = b(i);
+		who = b.info().who_take_turns;
+		result = 0;
+		reserved[0] = 0;
+	}
+
+	/**
+	 * apply the s-th symmetry to both the stones and the policy
+	 */
+	void transform(int s) {
+		const std::array<int, points>& image = board::symmetry(s);
+		replay_record copy = *this;
+		for (int i = 0; i < points; i++) {
+			stone[image[i]] = copy.stone[i];
+			policy[image[i]] = copy.policy[i];
+		}
+	}
+};
+
+/**
+ * ring buffer of records, memory-mapped from a file that keeps the records across runs
+ *
+ * the file is a header followed by 'capacity' records,
+ * when full, the oldest record is overwritten
+ */
+class replay_buffer {
+public:
+	static constexpr uint64_t magic = 0x59414c504f474f4eull; // "NOGOPLAY"
+	struct header {
+		uint64_t magic;
+		uint64_t capacity;
+		uint64_t head; // the total number of records ever written
+		uint64_t record_size;
+	};
+
+	replay_buffer() : base(nullptr), length(0) {}
+	replay_buffer(const std::string& path, size_t capacity = 100000) : replay_buffer() { open(path, capacity); }
+	replay_buffer(const replay_buffer&) = delete;
+	replay_buffer& operator =(const replay_buffer&) = delete;
+	~replay_buffer() { close(); }
+
+public:
+	/**
+	 * open an existing buffer, or create a new one with the given capacity
+	 */
+	void open(const std::string& path, size_t capacity = 100000) {
+		close();
+		int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+		if (fd == -1) throw std::runtime_error("cannot open replay buffer: " + path);
+		struct stat st;
+		if (fstat(fd, &st) == -1) {
+			::close(fd);
+			throw std::runtime_error("cannot open replay buffer: " + path);
+		}
+		bool create = st.st_size == 0;
+		if (!create) { // use the capacity of the existing buffer
+			header h;
+			if (pread(fd, &h, sizeof(h), 0) != ssize_t(sizeof(h)) || h.magic != magic || h.record_size != sizeof(replay_record)) {
+				::close(fd);
+				throw std::runtime_error("invalid replay buffer: " + path);
+			}
+			capacity = h.capacity;
+		}
+		size_t size = sizeof(header) + capacity * sizeof(replay_record);
+		if ((create || size_t(st.st_size) < size) && ftruncate(fd, size) == -1) {
+			::close(fd);
+			throw std::runtime_error("cannot resize replay buffer: " + path);
+		}
+		void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		::close(fd);
+		if (addr == MAP_FAILED) throw std::runtime_error("cannot map replay buffer: " + path);
+		base = addr;
+		length = size;
+		if (create) *info() = { magic, capacity, 0, sizeof(replay_record) };
+	}
+
+	void close() {
+		if (base) {
+			msync(base, length, MS_SYNC);
+			munmap(base, length);
+		}
+		base = nullptr;
+		length = 0;
+	}
+
+	size_t capacity() const { return base ? info()->capacity : 0; }
+	size_t size() const { return base ? std::min(info()->head, info()->capacity) : 0; }
+	size_t written() const { return base ? info()->head : 0; }
+
+	void push(const replay_record& rec) {
+		header* h = info();
+		records()[h->head % h->capacity] = rec;
+		h->head++;
+	}
+
+	/**
+	 * the i-th record, from the oldest to the newest
+	 */
+	const replay_record& at(size_t i) const {
+		const header* h = info();
+		size_t first = h->head > h->capacity ? h->head - h->capacity : 0;
+		return records()[(first + i) % h->capacity];
+	}
+
+	/**
+	 * a random record under a random symmetry, the buffer must not be empty
+	 */
+	template<typename engine_type>
+	replay_record sample(engine_type& engine) const {
+		if (size() == 0) throw std::out_of_range("sample from an empty replay buffer");
+		replay_record rec = at(std::uniform_int_distribution<size_t>(0, size() - 1)(engine));
+		rec.transform(std::uniform_int_distribution<int>(0, 7)(engine));
+		return rec;
+	}
+
+private:
+	header* info() const { return static_cast<header*>(base); }
+	replay_record* records() const { return reinterpret_cast<replay_record*>(info() + 1); }
+
+private:
+	void* base;
+	size_t length;
+};
@@ -0,0 +1,79 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * sprt.h: Sequential probability ratio test for engine A/B matches
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <cmath>
+
+/**
+ * test H0: elo = elo0 against H1: elo = elo1 on a stream of wins and losses
+ *
+ * NoGo has no draws, so the games are Bernoulli trials with the expected score of the elo difference,
+ * the test stops once the log-likelihood ratio leaves (log(beta / (1 - alpha)), log((1 - beta) / alpha))
+ */
+class sprt {
+public:
+	/**
+	 * the arguments are "elo0,elo1,alpha,beta", where the trailing ones may be omitted, e.g., "0,10"
+	 */
+	sprt(const std::string& args = "") : elo0(0), elo1(5), alpha(0.05), beta(0.05), wins(0), losses(0) {
+		std::stringstream ss(args);
+		std::string token;
+		double* param[] = { &elo0, &elo1, &alpha, &beta };
+		for (double* p : param) {
+			if (!std::getline(ss, token, ',')) break;
+			if (token.size()) *p = std::stod(token);
+		}
+	}
+
+public:
+	void update(bool win) {
+		(win ? wins : losses)++;
+	}
+
+	double llr() const {
+		double p0 = score(elo0), p1 = score(elo1);
+		return wins * std::log(p1 / p0) + losses * std::log((1 - p1) / (1 - p0));
+	}
+	double lower() const { return std::log(beta / (1 - alpha)); }
+	double upper() const { return std::log((1 - beta) / alpha); }
+
+	/**
+	 * -1 if H0 is accepted, +1 if H1 is accepted, or 0 if undecided
+	 */
+	int status() const {
+		double r = llr();
+		return r <= lower() ? -1 : r >= upper() ? 1 : 0;
+	}
+
+	/**
+	 * show the progress of the test
+	 *
+	 * the format is
+	 * 120    W-L = 70-50, llr = 1.23 [-2.94, 2.94]
+	 */
+	void show(std::ostream& out = std::cout) const {
+		out << (wins + losses) << "\t" << "W-L = " << wins << "-" << losses << ", ";
+		out << "llr = " << llr() << " [" << lower() << ", " << upper() << "]";
+		if (status()) out << ", H" << (status() > 0 ? 1 : 0) << " accepted";
+		out << std::endl;
+	}
+
+private:
+	static double score(double elo) {
+		return 1 / (1 + std::pow(10, -elo / 400));
+	}
+
+private:
+	double elo0, elo1;
+	double alpha, beta;
+	size_t wins, losses;
+};
@@ -0,0 +1,125 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * spsa.h: Simultaneous perturbation stochastic approximation (SPSA) tuner for agent parameters
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <string>
+#include <sstream>
+#include <vector>
+#include <random>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
+#include "episode.h"
+#include "statistics.h"
+#include "tournament.h"
+
+/**
+ * tune numeric agent parameters by SPSA
+ *
+ * every iteration perturbs all parameters at once by +/- c_k, plays a batch of games between
+ * the two perturbed agents with colors swapped, and moves the parameters along the estimated gradient,
+ * where a_k = r * c^2 / (A + k + 1)^0.602, c_k = c / (k + 1)^0.101, and A is 10% of the iterations
+ *
+ * the parameters are declared as "name=start:min:max:c", e.g., "explore=0.5:0.05:2:0.1 T=1000:100:5000:200",
+ * and are passed to the agents by their arguments, so integral ones are truncated by the agents
+ */
+class spsa_tuner {
+public:
+	spsa_tuner(const std::string& spec, const std::string& args = "", size_t threads = 1, double r = 2)
+		: args(args), threads(threads), r(r), engine(std::random_device()()) {
+		std::stringstream ss(spec);
+		for (std::string decl; ss >> decl; ) {
+			param p;
+			p.name = decl.substr(0, decl.find('='));
+			std::stringstream values(decl.substr(decl.find('=') + 1));
+			std::string token;
+			double* fields[] = { &p.value, &p.min, &p.max, &p.c };
+			size_t n = 0;
+			for (double* f : fields) {
+				if (!std::getline(values, token, ':')) break;
+				*f = std::stod(token);
+				n++;
+			}
+			if (p.name.empty() || n != 4 || p.min > p.max || p.c <= 0)
+				throw std::invalid_argument("invalid parameter: " + decl + ", should be name=start:min:max:c");
+			params.push_back(p);
+		}
+		if (params.empty()) throw std::invalid_argument("no parameter to tune");
+		std::stringstream sa(args);
+		for (std::string pair; sa >> pair; )
+			if (pair.find("seed=") == 0) engine.seed(std::stoul(pair.substr(5)));
+	}
+
+public:
+	/**
+	 * run the given iterations of 'games' games each, and log every iteration
+	 *
+	 * the format is
+	 * 12     explore=0.532 T=1180, plus|minus = 6|4
+	 */
+	void run(size_t iterations, size_t games, std::ostream& out = std::cout) {
+		double A = iterations * 0.1;
+		games = std::max<size_t>(2, games);
+		for (size_t k = 0; k < iterations; k++) {
+			double ak = r / std::pow(A + k + 1, 0.602), ck = 1 / std::pow(k + 1, 0.101);
+			std::vector<int> delta(params.size());
+			std::string plus = args, minus = args;
+			for (size_t i = 0; i < params.size(); i++) {
+				delta[i] = std::bernoulli_distribution(0.5)(engine) ? 1 : -1;
+				const param& p = params[i];
+				plus += " " + p.name + "=" + std::to_string(clamp(p, p.value + ck * p.c * delta[i]));
+				minus += " " + p.name + "=" + std::to_string(clamp(p, p.value - ck * p.c * delta[i]));
+			}
+			plus += " name=plus"; // after the arguments, which may have their own name
+			minus += " name=minus";
+
+			size_t won = 0;
+			statistics stats(games);
+			stats.listen([&](const episode& game) { won += (game.winner() == "plus"); });
+			tournament match({ seed_args(plus, k * 2), seed_args(minus, k * 2 + 1) }, threads);
+			match.run(stats);
+
+			double score = (won * 2.0 - games) / games; // the score of plus minus the score of minus, in [-1, 1]
+			for (size_t i = 0; i < params.size(); i++) {
+				param& p = params[i];
+				double gradient = score / (2 * ck * p.c * delta[i]);
+				p.value = clamp(p, p.value + ak * p.c * p.c * gradient);
+			}
+
+			out << (k + 1) << "\t" << values() << ", plus|minus = " << won << "|" << (games - won) << std::endl;
+		}
+	}
+
+	/**
+	 * the current parameters as agent arguments
+	 */
+	std::string values() const {
+		std::stringstream ss;
+		for (const param& p : params) ss << (&p == &params[0] ? "" : " ") << p.name << "=" << p.value;
+		return ss.str();
+	}
+
+private:
+	struct param {
+		std::string name;
+		double value, min, max, c;
+	};
+
+	static double clamp(const param& p, double value) {
+		return std::max(p.min, std::min(p.max, value));
+	}
+
+private:
+	std::vector<param> params;
+	std::string args;
+	size_t threads;
+	double r;
+	std::default_random_engine engine;
+};
@@ -9,9 +9,11 @@
 
 #pragma once
 #include <deque>
+#include <vector>
 #include <algorithm>
 #include <iostream>
 #include <sstream>
+#include <functional>
 #include "board.h"
 #include "action.h"
 #include "episode.h"
@@ -47,11 +49,12 @@ public:
 	 *  'ops = 125762 (132018|135377)': the average speed is 125762
 	 *                                  the average speed of black is 132018
 	 *                                  the average speed of white is 135377
+	 *  where the speed is the moves per second of thinking time, measured in nanoseconds
 	 */
 	void show(size_t blk = 0) const {
 		size_t num = std::min(data.size(), blk ?: block);
 		size_t sop = 0, Bop = 0, Wop = 0;
-		time_t sdu = 0, Bdu = 0, Wdu = 0;
+		time_t Bdu = 0, Wdu = 0;
 		size_t BW = 0, WW = 0;
 		auto it = data.end();
 		for (size_t i = 0; i < num; i++) {
@@ -61,9 +64,8 @@ public:
 			sop += ep.step();
 			Bop += ep.step(action::black::type);
 			Wop += ep.step(action::white::type);
-			sdu += ep.time();
-			Bdu += ep.time(action::black::type);
-			Wdu += ep.time(action::white::type);
+			Bdu += ep.nanos(action::black::type);
+			Wdu += ep.nanos(action::white::type);
 		}
 
 		std::cout << count << "\t";
@@ -72,12 +74,46 @@ public:
 		std::cout << "op = "  << (sop * 1.0 / num)
 		          <<     " (" << (Bop * 1.0 / num)
 		          <<      "|" << (Wop * 1.0 / num) << "), ";
-		std::cout << "ops = " << (sop * 1000.0 / sdu)
-		          <<     " (" << (Bop * 1000.0 / Bdu)
-		          <<      "|" << (Wop * 1000.0 / Wdu) << ")";
+		std::cout << "ops = " << (sop * 1e9 / std::max<time_t>(Bdu + Wdu, 1))
+		          <<     " (" << (Bop * 1e9 / std::max<time_t>(Bdu, 1))
+		          <<      "|" << (Wop * 1e9 / std::max<time_t>(Wdu, 1)) << ")";
 		std::cout << std::endl;
 	}
 
+	/**
+	 * show the average thinking time of every ply over the last 'block' games
+	 *
+	 * the format is
+	 * 12     avg = 1234.56 us, max = 2345.67 us (987 games)
+	 *
+	 * where '12' is the ply, i.e., the 12th move of a game
+	 */
+	void profile(size_t blk = 0) const {
+		size_t num = std::min(data.size(), blk ?: block);
+		std::vector<time_t> sum, max;
+		std::vector<size_t> games;
+		auto it = data.end();
+		for (size_t i = 0; i < num; i++) {
+			auto& ep = *(--it);
+			for (size_t ply = 0; ply < ep.step(); ply++) {
+				if (ply >= sum.size()) {
+					sum.resize(ply + 1, 0);
+					max.resize(ply + 1, 0);
+					games.resize(ply + 1, 0);
+				}
+				sum[ply] += ep.nanos_at(ply);
+				max[ply] = std::max(max[ply], ep.nanos_at(ply));
+				games[ply]++;
+			}
+		}
+		for (size_t ply = 0; ply < sum.size(); ply++) {
+			std::cout << (ply + 1) << "\t";
+			std::cout << "avg = " << (sum[ply] / 1000.0 / games[ply]) << " us, ";
+			std::cout << "max = " << (max[ply] / 1000.0) << " us ";
+			std::cout << "(" << games[ply] << " games)" << std::endl;
+		}
+	}
+
 	void summary() const {
 		show(data.size());
 	}
@@ -99,6 +135,31 @@ public:
 	void close_episode(const std::string& flag = "") {
 		data.back().close_episode(flag);
 		if (count % block == 0) show();
+		if (notify) notify(data.back());
+	}
+
+	/**
+	 * add an episode that has been played elsewhere, e.g., by another thread
+	 */
+	void append(episode&& ep) {
+		if (count++ >= limit) data.pop_front();
+		data.push_back(std::move(ep));
+		if (count % block == 0) show();
+		if (notify) notify(data.back());
+	}
+
+	/**
+	 * call 'listener' whenever an episode is closed or appended, e.g., to stop a match early by finish()
+	 */
+	void listen(std::function<void(const episode&)> listener) {
+		notify = listener;
+	}
+
+	/**
+	 * finish now, regardless of the total episodes
+	 */
+	void finish() {
+		total = count;
 	}
 
 	episode& at(size_t i) {
@@ -113,6 +174,12 @@ public:
 	size_t step() const {
 		return count;
 	}
+	size_t total_episodes() const {
+		return total;
+	}
+	size_t size() const {
+		return data.size();
+	}
 
 	friend std::ostream& operator <<(std::ostream& out, const statistics& stat) {
 		for (const episode& rec : stat.data) out << rec << std::endl;
@@ -134,4 +201,5 @@ private:
 	size_t limit;
 	size_t count;
 	std::deque<episode> data;
+	std::function<void(const episode&)> notify;
 };
@@ -0,0 +1,148 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * suite.h: Test suite of positions with known best moves
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+#include "board.h"
+#include "action.h"
+#include "agent.h"
+
+/**
+ * positions annotated with the moves that solve them, and the moves that fail them
+ *
+ * every position starts with a header line, followed by a board diagram unless the moves are given, e.g.,
+ *   # comment
+ *   opening1 black best=E5 moves=;B[ee];W[dc]
+ *   corner2 white best=A1,J9 avoid=B2
+ *     A B C D E F G H J
+ *   9 · · · · · · · · · 9
+ *   ...
+ *   1 · · · · · · · · · 1
+ *     A B C D E F G H J
+ * where the header is the id, the player to move (which must agree with the moves if given), and the annotations:
+ *  'best' lists the moves that solve the position, and
+ *  'avoid' lists the moves that fail it, any other move solves it if 'best' is not given
+ */
+class test_suite {
+public:
+	struct position {
+		std::string id;
+		board state;
+		std::vector<int> best;
+		std::vector<int> avoid;
+		bool solved(int i) const {
+			if (std::find(avoid.begin(), avoid.end(), i) != avoid.end()) return false;
+			return best.empty() || std::find(best.begin(), best.end(), i) != best.end();
+		}
+	};
+
+	test_suite(const std::string& path) {
+		std::ifstream in(path);
+		if (!in.is_open()) throw std::runtime_error("cannot open suite: " + path);
+		for (std::string line; std::getline(in, line); ) {
+			if (line.empty() || line[0] == '#' || line.find_first_not_of(" \t\r") == std::string::npos) continue;
+			position pos;
+			std::string who, moves;
+			bool diagram = true;
+			std::stringstream ss(line);
+			ss >> pos.id >> who;
+			for (std::string pair; ss >> pair; ) {
+				std::string key = pair.substr(0, pair.find('='));
+				std::string value = pair.substr(pair.find('=') + 1);
+				if (key == "best" || key == "avoid") {
+					std::stringstream list(value);
+					for (std::string move; std::getline(list, move, ','); )
+						(key == "best" ? pos.best : pos.avoid).push_back(board::point(move).i);
+				} else if (key == "moves") {
+					moves = value;
+					diagram = false;
+				}
+			}
+			if (diagram && !(in >> pos.state))
+				throw std::runtime_error("invalid diagram of " + pos.id + " in suite: " + path);
+			std::stringstream sgf(moves);
+			for (action::place move; (sgf >> std::ws).peek() != EOF; ) {
+				if (!(move << sgf) || move.apply(pos.state) != board::legal)
+					throw std::runtime_error("invalid moves of " + pos.id + " in suite: " + path);
+			}
+			if (who != "black" && who != "white")
+				throw std::runtime_error("invalid player of " + pos.id + " in suite: " + path);
+			board::piece_type turn = who == "black" ? board::black : board::white;
+			if (!diagram && pos.state.info().who_take_turns != turn) // the moves imply the player to move
+				throw std::runtime_error("player to move of " + pos.id + " disagrees with its moves in suite: " + path);
+			pos.state.info({ turn });
+			positions.push_back(pos);
+		}
+	}
+
+public:
+	size_t size() const { return positions.size(); }
+
+	/**
+	 * run the agent on every position with doubling playout budgets 'T' from 'min' to 'max',
+	 * where a position is solved at the first budget that plays a solving move
+	 *
+	 * the format is
+	 * opening1     solved    T = 800     move = E5     time = 0.123 s, nps = 6504
+	 * ...
+	 * solved = 12/20 (60%), time-to-solve = 0.321 s, nps = 7011
+	 *
+	 * where 'time' is the total time of the searches until solved, and 'nps' is the playouts per second
+	 */
+	void run(const std::string& args, size_t min, size_t max, std::ostream& out = std::cout) const {
+		size_t solved = 0, playouts = 0;
+		double solve_time = 0, total_time = 0;
+		size_t width = 8;
+		for (const position& pos : positions) width = std::max(width, pos.id.size());
+		for (const position& pos : positions) {
+			std::string role = pos.state.info().who_take_turns == board::black ? "black" : "white";
+			bool done = false;
+			size_t budget = std::max<size_t>(1, min);
+			double elapsed = 0, spent = 0;
+			size_t searched = 0;
+			action::place move;
+			for (; !done && budget <= max; budget *= 2) {
+				std::unique_ptr<agent> player(create_player("name=suite " + args + " T=" + std::to_string(budget) + " role=" + role));
+				auto start = std::chrono::steady_clock::now();
+				action result = player->take_action(pos.state);
+				elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				move = result;
+				done = result.type() == action::place::type && pos.solved(move.position().i);
+				spent += elapsed;
+				searched += budget;
+			}
+			budget /= 2;
+			total_time += spent;
+			playouts += searched;
+			if (done) {
+				solved++;
+				solve_time += spent;
+			}
+			out << std::left << std::setw(width + 2) << pos.id << std::setw(10) << (done ? "solved" : "unsolved")
+			    << "T = " << std::setw(8) << budget << "move = " << std::setw(6) << std::string(move.position())
+			    << "time = " << spent << " s, nps = " << size_t(searched / std::max(spent, 1e-9)) << std::endl;
+		}
+		out << std::right;
+		out << "solved = " << solved << "/" << size() << " (" << (size() ? solved * 100.0 / size() : 0) << "%), ";
+		out << "time-to-solve = " << (solved ? solve_time / solved : 0) << " s, ";
+		out << "nps = " << size_t(playouts / std::max(total_time, 1e-9)) << std::endl;
+	}
+
+private:
+	std::vector<position> positions;
+};
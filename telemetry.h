@@ -0,0 +1,114 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * telemetry.h: Per-move search telemetry with low-overhead cycle counters
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <array>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "board.h"
+#include "counters.h"
+#include "alloc.h"
+
+/**
+ * the time stamp counter, or nanoseconds where it is not available
+ */
+inline uint64_t cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/**
+ * the statistics of a search for a move
+ *
+ * the phase times are in cycles of the time stamp counter, only their proportions are shown
+ */
+struct search_telemetry {
+	enum phase { select, expand, simulate, backpropagate, phases };
+
+	size_t iterations = 0;
+	size_t nodes = 0; // the nodes allocated, including the root
+	size_t pruned = 0; // the nodes recycled to keep within the node budget
+	size_t max_depth = 0;
+	size_t sum_depth = 0;
+	double seconds = 0;
+	std::array<uint64_t, phases> cycles = {};
+	std::vector<std::pair<int, int>> visits; // the visit count of every root move, most visited first
+	bool counted = false; // whether the hardware counters below are available
+	perf_counters::values search_events = {}; // of the whole search
+	perf_counters::values rollout_events = {}; // of the simulations only, estimated from sampled playouts
+	size_t allocations = 0; // during the search, only counted by 'make alloc'
+	size_t tree_bytes = 0; // the bytes reserved by the tree and its spare pool at the end of the search
+
+	void clear() { *this = {}; }
+
+	double playouts_per_second() const { return seconds > 0 ? iterations / seconds : 0; }
+	double avg_depth() const { return iterations ? sum_depth * 1.0 / iterations : 0; }
+	double ipc(const perf_counters::values& events) const {
+		return events[perf_counters::cycles] ? events[perf_counters::instructions] * 1.0 / events[perf_counters::cycles] : 0;
+	}
+	double per_playout(const perf_counters::values& events, perf_counters::event e) const {
+		return iterations ? events[e] * 1.0 / iterations : 0;
+	}
+	double share(phase p) const {
+		uint64_t total = 0;
+		for (uint64_t c : cycles) total += c;
+		return total ? cycles[p] * 1.0 / total : 0;
+	}
+
+	/**
+	 * show the telemetry in a line
+	 *
+	 * the format is
+	 * T = 1000, pps = 12345, nodes = 1050, depth = 7|3.21, time = 81ms (select 3%, expand 20%, simulate 76%, backprop 1%), visits = E5:310 D4:120 ...
+	 *
+	 * where 'depth' is the max|average depth of the selected leaves, and 'visits' lists the top 5 root moves,
+	 * and 'nodes' is followed by the pruned nodes (e.g., "nodes = 1050 (-200)") if any
+	 *
+	 * with the hardware counters, a second line follows
+	 * ipc = 1.85|2.01, cache-misses/playout = 35.2|30.1, branch-misses/playout = 410.5|395.2
+	 *
+	 * where the values are of the whole search|the simulations
+	 *
+	 * with the allocation tracking of 'make alloc', another line follows
+	 * allocations = 1050 (1.05/playout), tree = 98.4KB
+	 */
+	void show(std::ostream& out = std::cerr) const {
+		out << "T = " << iterations << ", pps = " << size_t(playouts_per_second()) << ", nodes = " << nodes;
+		if (pruned) out << " (-" << pruned << ")";
+		out << ", ";
+		out << "depth = " << max_depth << "|" << avg_depth() << ", time = " << size_t(seconds * 1000) << "ms (";
+		const char* name[] = { "select", "expand", "simulate", "backprop" };
+		for (int p = 0; p < phases; p++)
+			out << (p ? ", " : "") << name[p] << " " << size_t(share(phase(p)) * 100 + 0.5) << "%";
+		out << "), visits =";
+		for (size_t i = 0; i < std::min<size_t>(5, visits.size()); i++)
+			out << " " << std::string(board::point(visits[i].first)) << ":" << visits[i].second;
+		out << std::endl;
+		if (alloc_tracker::enabled) {
+			out << "allocations = " << allocations << " (" << (iterations ? allocations * 1.0 / iterations : 0) << "/playout), ";
+			out << "tree = " << tree_bytes / 1024.0 << "KB" << std::endl;
+		}
+		if (!counted) return;
+		out << "ipc = " << ipc(search_events) << "|" << ipc(rollout_events) << ", ";
+		out << "cache-misses/playout = " << per_playout(search_events, perf_counters::cache_misses)
+		    << "|" << per_playout(rollout_events, perf_counters::cache_misses) << ", ";
+		out << "branch-misses/playout = " << per_playout(search_events, perf_counters::branch_misses)
+		    << "|" << per_playout(rollout_events, perf_counters::branch_misses) << std::endl;
+	}
+};
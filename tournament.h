@@ -0,0 +1,236 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * tournament.h: Round-robin tournament among agent configurations with Elo estimation
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <vector>
+#include <map>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
+#include "agent.h"
+#include "episode.h"
+#include "statistics.h"
+#include "arena.h"
+
+/**
+ * play every pairing of the configurations, swapping colors every game,
+ * and estimate the Elo ratings by the Bradley-Terry model
+ *
+ * the configuration file has one agent per line, e.g.,
+ *   name=uct T=1000
+ *   name=puct search=puct eval=ntuple weights=ntuple.bin
+ * where empty lines and lines starting with '#' are ignored,
+ * and an agent without a name is named by its order, e.g., "agent3"
+ */
+class tournament {
+public:
+	tournament(const std::string& path, size_t threads = 1) : tournament(read(path), threads) {}
+	tournament(const std::vector<std::string>& lines, size_t threads = 1) {
+		for (const std::string& line : lines) {
+			std::string name = "agent" + std::to_string(configs.size() + 1);
+			std::stringstream ss(line);
+			for (std::string pair; ss >> pair; )
+				if (pair.find("name=") == 0) name = pair.substr(5);
+			if (index.count(name)) throw std::invalid_argument("duplicated agent: " + name);
+			index[name] = configs.size();
+			names.push_back(name);
+			configs.push_back("name=" + name + " " + line);
+		}
+		if (configs.size() < 2) throw std::invalid_argument("tournament needs at least 2 agents");
+
+		for (size_t t = 0; t < std::max<size_t>(1, threads); t++) { // create in the main thread to report errors
+			players.emplace_back();
+			for (const std::string& config : configs) {
+				std::string black = config + " role=black", white = config + " role=white";
+				if (threads > 1) {
+					black = seed_args(black, t);
+					white = seed_args(white, t);
+				}
+				players[t].emplace_back(std::unique_ptr<agent>(create_player(black)), std::unique_ptr<agent>(create_player(white)));
+			}
+		}
+	}
+
+public:
+	/**
+	 * the configurations listed in a file
+	 */
+	static std::vector<std::string> read(const std::string& path) {
+		std::ifstream in(path);
+		if (!in.is_open()) throw std::runtime_error("cannot open tournament: " + path);
+		std::vector<std::string> lines;
+		for (std::string line; std::getline(in, line); ) {
+			if (line.empty() || line[0] == '#' || line.find_first_not_of(" \t\r") == std::string::npos) continue;
+			lines.push_back(line);
+		}
+		return lines;
+	}
+
+	size_t size() const { return configs.size(); }
+	const std::string& name(size_t i) const { return names[i]; }
+	size_t pairings() const { return size() * (size() - 1) / 2; }
+
+	/**
+	 * play until the statistics is finished, i.e., total / pairings() games for each pairing,
+	 * or until the statistics is finished early by its listener
+	 */
+	void run(statistics& stats) {
+		std::vector<std::pair<size_t, size_t>> schedule; // interleaved so that partial results cover every pairing
+		size_t rounds = stats.total_episodes() / pairings();
+		for (size_t g = 0; g < rounds; g++) {
+			for (size_t i = 0; i < size(); i++) {
+				for (size_t j = i + 1; j < size(); j++) {
+					schedule.push_back(g % 2 ? std::make_pair(j, i) : std::make_pair(i, j));
+				}
+			}
+		}
+		wins.assign(size(), std::vector<size_t>(size(), 0));
+		moves.assign(size(), 0);
+		usage.assign(size(), 0);
+
+		auto start = std::chrono::steady_clock::now();
+		std::atomic<size_t> next(0);
+		std::atomic<bool> stop(false);
+		std::vector<std::thread> workers;
+		for (size_t t = 0; t < players.size(); t++) {
+			workers.emplace_back([&, t]() {
+				for (size_t k; !stop && (k = next++) < schedule.size(); ) {
+					episode game;
+					play_episode(*players[t][schedule[k].first].first, *players[t][schedule[k].second].second, game);
+					finished.push(std::move(game));
+				}
+			});
+		}
+
+		std::vector<episode> done;
+		for (size_t count = 0; count < schedule.size() && !stats.is_finished(); ) {
+			done.clear();
+			if (finished.drain(done) == 0) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				continue;
+			}
+			for (episode& game : done) {
+				if (stats.is_finished()) break; // the rest are discarded
+				std::string names = game.players();
+				size_t black = index.at(names.substr(0, names.find(':')));
+				size_t white = index.at(names.substr(names.find(':') + 1));
+				size_t win = index.at(game.winner());
+				wins[win][win == black ? white : black]++;
+				moves[black] += game.step(action::black::type);
+				moves[white] += game.step(action::white::type);
+				usage[black] += game.nanos(action::black::type);
+				usage[white] += game.nanos(action::white::type);
+				stats.append(std::move(game));
+			}
+			count += done.size();
+		}
+		stop = true;
+		for (std::thread& worker : workers) worker.join();
+		elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	/**
+	 * show the Elo table, sorted by rating
+	 *
+	 * the format is
+	 * rank  name      elo     +/-     games  score   ms/move
+	 * 1     puct      +85.2   31.0    400    62.0%   12.345
+	 *
+	 * where the ratings are relative to the average, and '+/-' is the 95% confidence interval
+	 */
+	void report(std::ostream& out = std::cout) const {
+		std::vector<double> rating, error;
+		estimate(rating, error);
+		std::vector<size_t> order(size());
+		for (size_t i = 0; i < size(); i++) order[i] = i;
+		std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return rating[a] > rating[b]; });
+
+		size_t width = 4;
+		for (const std::string& name : names) width = std::max(width, name.size());
+		size_t total = 0;
+		out << std::left << std::setw(6) << "rank" << std::setw(width + 2) << "name" << std::setw(9) << "elo" << std::setw(8) << "+/-"
+		    << std::setw(8) << "games" << std::setw(9) << "score" << "ms/move" << std::endl;
+		for (size_t r = 0; r < size(); r++) {
+			size_t i = order[r];
+			size_t won = 0, games = 0;
+			for (size_t j = 0; j < size(); j++) {
+				won += wins[i][j];
+				games += wins[i][j] + wins[j][i];
+			}
+			total += won;
+			std::stringstream elo, score;
+			elo << std::showpos << std::fixed << std::setprecision(1) << rating[i];
+			score << std::fixed << std::setprecision(1) << (games ? won * 100.0 / games : 0) << "%";
+			out << std::setw(6) << (r + 1) << std::setw(width + 2) << names[i] << std::setw(9) << elo.str()
+			    << std::setw(8) << std::fixed << std::setprecision(1) << error[i] << std::setw(8) << games << std::setw(9) << score.str()
+			    << std::setprecision(3) << (moves[i] ? usage[i] / 1e6 / moves[i] : 0) << std::endl;
+		}
+		out << std::right << std::defaultfloat;
+		out << total << " games in " << elapsed << " seconds, " << (total / elapsed) << " games/sec" << std::endl;
+	}
+
+	/**
+	 * the maximum-likelihood Bradley-Terry ratings by minorization-maximization,
+	 * with a prior of one virtual win and one virtual loss against a virtual opponent of the average rating
+	 * the errors come from the diagonal of the observed Fisher information
+	 */
+	void estimate(std::vector<double>& rating, std::vector<double>& error, size_t iterations = 1000) const {
+		std::vector<double> gamma(size(), 1.0);
+		for (size_t it = 0; it < iterations; it++) {
+			for (size_t i = 0; i < size(); i++) {
+				double won = 1, denom = 2 / (gamma[i] + 1);
+				for (size_t j = 0; j < size(); j++) {
+					if (j == i) continue;
+					won += wins[i][j];
+					denom += (wins[i][j] + wins[j][i]) / (gamma[i] + gamma[j]);
+				}
+				gamma[i] = won / denom;
+			}
+			double mean = 0; // keep the geometric mean at 1
+			for (double g : gamma) mean += std::log(g);
+			mean = std::exp(mean / size());
+			for (double& g : gamma) g /= mean;
+		}
+
+		const double elo = 400 / std::log(10);
+		rating.assign(size(), 0);
+		error.assign(size(), 0);
+		for (size_t i = 0; i < size(); i++) {
+			double info = 2 * gamma[i] / ((gamma[i] + 1) * (gamma[i] + 1));
+			for (size_t j = 0; j < size(); j++) {
+				if (j == i) continue;
+				double p = gamma[i] / (gamma[i] + gamma[j]);
+				info += (wins[i][j] + wins[j][i]) * p * (1 - p);
+			}
+			rating[i] = elo * std::log(gamma[i]);
+			error[i] = 1.96 * elo / std::sqrt(info);
+		}
+	}
+
+private:
+	std::vector<std::string> configs;
+	std::vector<std::string> names;
+	std::map<std::string, size_t> index;
+	std::vector<std::vector<std::pair<std::unique_ptr<agent>, std::unique_ptr<agent>>>> players;
+	mpsc_queue<episode> finished;
+
+	std::vector<std::vector<size_t>> wins; // wins[i][j] is the number of games i won against j
+	std::vector<size_t> moves;
+	std::vector<time_t> usage; // in nanoseconds
+	double elapsed = 0;
+};
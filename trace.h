@@ -0,0 +1,161 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * trace.h: Chrome/Perfetto trace events of games, moves, and searches
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <cstdint>
+#include <cstdlib>
+
+/**
+ * collect complete events ("ph":"X") into per-thread buffers, and write them as a JSON trace
+ *
+ * a thread registers its buffer under a lock on its first event, and then appends without locking,
+ * the threads are numbered in the order of their first events,
+ * the buffers are written by flush(), which is also called at exit once tracing is opened,
+ * so flush() should only run when the traced threads are finished
+ *
+ * the names and categories must be string literals, since only the pointers are kept
+ */
+class tracer {
+public:
+	static tracer& instance() {
+		static tracer t;
+		return t;
+	}
+
+	static int64_t now() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+public:
+	bool enabled() const { return on.load(std::memory_order_relaxed); }
+
+	/**
+	 * start tracing into the given file
+	 */
+	void open(const std::string& file) {
+		std::lock_guard<std::mutex> lock(mutex);
+		path = file;
+		origin = now();
+		if (!registered) std::atexit([]() { tracer::instance().flush(); });
+		registered = true;
+		on = true;
+	}
+
+	/**
+	 * record an event of the calling thread, with the begin and end times from now()
+	 */
+	void record(const char* name, const char* cat, int64_t begin, int64_t end) {
+		if (!enabled()) return;
+		local().events.push_back({ name, cat, begin, end - begin });
+	}
+
+	/**
+	 * write all the buffers to the file, and stop tracing
+	 */
+	void flush() {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!on) return;
+		on = false;
+		std::ofstream out(path, std::ios::out | std::ios::trunc);
+		out << "{\"traceEvents\":[" << std::endl;
+		bool first = true;
+		for (const std::unique_ptr<buffer>& buf : buffers) {
+			out << (first ? "" : ",\n");
+			out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buf->tid
+			    << ",\"args\":{\"name\":\"thread " << buf->tid << "\"}}";
+			first = false;
+			for (const event& e : buf->events) {
+				out << ",\n{\"name\":\"" << e.name << "\",\"cat\":\"" << e.cat << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buf->tid
+				    << ",\"ts\":" << micro(e.begin - origin) << ",\"dur\":" << micro(e.duration) << "}";
+			}
+		}
+		out << std::endl << "],\"displayTimeUnit\":\"ns\"}" << std::endl;
+	}
+
+private:
+	tracer() : on(false), registered(false), origin(0) {}
+
+	struct event {
+		const char* name;
+		const char* cat;
+		int64_t begin;
+		int64_t duration;
+	};
+	struct buffer {
+		unsigned tid;
+		std::vector<event> events;
+	};
+
+	buffer& local() {
+		thread_local buffer* mine = nullptr;
+		if (!mine) {
+			std::lock_guard<std::mutex> lock(mutex);
+			buffers.emplace_back(new buffer{ unsigned(buffers.size()), {} });
+			buffers.back()->events.reserve(1 << 16);
+			mine = buffers.back().get();
+		}
+		return *mine;
+	}
+
+	static std::string micro(int64_t ns) {
+		std::string frac = std::to_string(1000 + ns % 1000).substr(1);
+		return std::to_string(ns / 1000) + "." + frac;
+	}
+
+private:
+	std::atomic<bool> on;
+	bool registered;
+	int64_t origin;
+	std::string path;
+	std::mutex mutex;
+	std::vector<std::unique_ptr<buffer>> buffers;
+};
+
+/**
+ * record the lifetime of this object as an event, if tracing
+ */
+class trace_scope {
+public:
+	trace_scope(const char* name, const char* cat) : name(name), cat(cat), begin(tracer::instance().enabled() ? tracer::now() : 0) {}
+	~trace_scope() { if (begin) tracer::instance().record(name, cat, begin, tracer::now()); }
+
+private:
+	const char* name;
+	const char* cat;
+	int64_t begin;
+};
+
+/**
+ * record consecutive phases as events, each from the end of the previous one, if tracing
+ */
+class trace_phases {
+public:
+	trace_phases(const char* cat) : cat(cat), mark(tracer::instance().enabled() ? tracer::now() : 0) {}
+
+	/**
+	 * end the current phase with the given name, and start the next one
+	 */
+	void next(const char* name) {
+		if (!mark) return;
+		int64_t now = tracer::now();
+		tracer::instance().record(name, cat, mark, now);
+		mark = now;
+	}
+
+private:
+	const char* cat;
+	int64_t mark;
+};
@@ -0,0 +1,184 @@
+/**
+ * Framework for NoGo and similar games (C++ 11)
+ * trainer.h: TD-learning self-play trainer for the n-tuple network
+ *
+ * Author: Theory of Computer Games
+ *         Computer Games and Intelligence (CGI) Lab, NYCU, Taiwan
+ *         https://cgilab.nctu.edu.tw/
+ */
+
+#pragma once
+#include <string>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <chrono>
+#include <iostream>
+#include "board.h"
+#include "action.h"
+#include "episode.h"
+#include "ntuple.h"
+
+/**
+ * self-play TD(lambda) trainer, configured by key=value pairs
+ *
+ *  load=path       initial weights (zero weights of 'tuples' if not given)
+ *  save=path       where to save the weights, also used for checkpoints
+ *  tuples=spec     tuple shapes, see ntuple_network::init
+ *  alpha=0.1       learning rate of a position, shared by all its features
+ *  lambda=0        the lambda of TD(lambda), 0 for TD(0)
+ *  epsilon=0.1     the probability of playing a random move
+ *  threads=N       the number of training threads, all cores by default
+ *  checkpoint=N    save the weights every N games
+ *  seed=N          the seed of the random engines
+ *
+ * all threads update the shared weights without locking (Hogwild),
+ * occasional lost updates are harmless since the updates are sparse
+ */
+class td_trainer {
+public:
+	td_trainer(const std::string& args = "") : alpha(0.1f), lambda(0), epsilon(0.1f),
+		threads(std::max(1u, std::thread::hardware_concurrency())), checkpoint(10000),
+		seed(std::random_device()()), save_path("ntuple.bin") {
+		std::stringstream ss(args);
+		std::map<std::string, std::string> meta;
+		for (std::string pair; ss >> pair; )
+			meta[pair.substr(0, pair.find('='))] = pair.substr(pair.find('=') + 1);
+		if (meta.count("tuples")) network.init(meta["tuples"]);
+		if (meta.count("load")) network.load(meta["load"]);
+		if (meta.count("save")) save_path = meta["save"];
+		if (meta.count("alpha")) alpha = std::stof(meta["alpha"]);
+		if (meta.count("lambda")) lambda = std::stof(meta["lambda"]);
+		if (meta.count("epsilon")) epsilon = std::stof(meta["epsilon"]);
+		if (meta.count("threads")) threads = std::max(1ul, std::stoul(meta["threads"]));
+		if (meta.count("checkpoint")) checkpoint = std::stoul(meta["checkpoint"]);
+		if (meta.count("seed")) seed = std::stoul(meta["seed"]);
+	}
+
+public:
+	/**
+	 * train by 'total' self-play games, and report the progress every 'block' games
+	 */
+	void train(size_t total, size_t block = 0) {
+		block = block ? block : std::max<size_t>(1, total / 100);
+		std::atomic<size_t> games(0), moves(0), black_wins(0);
+		std::mutex report;
+		auto start = std::chrono::steady_clock::now();
+		auto last = start;
+		std::vector<std::thread> workers;
+		for (size_t t = 0; t < threads; t++) {
+			workers.emplace_back([&, t]() {
+				std::default_random_engine engine(seed + t);
+				for (size_t n; (n = games++) < total; ) {
+					episode game = play(engine);
+					learn(game);
+					moves += game.step();
+					black_wins += game.step() % 2;
+					if ((n + 1) % block == 0) {
+						std::lock_guard<std::mutex> lock(report);
+						auto now = std::chrono::steady_clock::now();
+						double sec = std::chrono::duration<double>(now - last).count();
+						last = now;
+						std::cout << (n + 1) << "\t" << "win = " << (black_wins * 100.0 / block) << "%"
+						          << "|" << (100 - black_wins * 100.0 / block) << "%, "
+						          << "op = " << (moves * 1.0 / block) << ", "
+						          << "games/s = " << (block / sec) << std::endl;
+						moves = 0;
+						black_wins = 0;
+					}
+					if (checkpoint && (n + 1) % checkpoint == 0 && n + 1 < total) {
+						std::lock_guard<std::mutex> lock(report);
+						network.save(save_path);
+					}
+				}
+			});
+		}
+		for (std::thread& worker : workers) worker.join();
+		network.save(save_path);
+		double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::cout << "train " << total << " games in " << sec << " s, save to " << save_path << std::endl;
+	}
+
+	ntuple_network<float>& weights() { return network; }
+
+protected:
+	/**
+	 * play a self-play game with epsilon-greedy moves
+	 * the greedy move leaves the opponent the position of the lowest value
+	 */
+	template<typename engine_type>
+	episode play(engine_type& engine) {
+		episode game;
+		game.open_episode("train:train");
+		std::uniform_real_distribution<float> explore(0, 1);
+		while (true) {
+			const board& state = game.state();
+			unsigned who = state.info().who_take_turns;
+			std::vector<action::place> legal;
+			std::vector<board> after;
+			for (int i = 0; i < board::size_x * board::size_y; i++) {
+				board b = state;
+				if (b.place(board::point(i), who) != board::legal) continue;
+				legal.emplace_back(i, who);
+				after.push_back(b);
+			}
+			if (legal.empty()) break;
+			size_t best = 0;
+			if (explore(engine) < epsilon) {
+				best = std::uniform_int_distribution<size_t>(0, legal.size() - 1)(engine);
+			} else {
+				float best_value = 2;
+				for (size_t k = 0; k < after.size(); k++) {
+					float value = network.estimate(after[k]);
+					if (value < best_value) {
+						best_value = value;
+						best = k;
+					}
+				}
+			}
+			game.apply_action(legal[best]);
+		}
+		game.close_episode("train");
+		return game;
+	}
+
+	/**
+	 * replay the moves of the episode and update the visited positions backward
+	 *
+	 * values are from the view of the player to move, so the return is negated at every ply,
+	 * the final position is a loss for the player to move since it has no legal move
+	 */
+	void learn(const episode& game) {
+		std::vector<ntuple_network<float>::cells> path;
+		board state;
+		path.push_back(ntuple_network<float>::encode(state));
+		for (const action& move : game.actions()) {
+			move.apply(state);
+			path.push_back(ntuple_network<float>::encode(state));
+		}
+		float rate = alpha / network.features();
+		float next = -1; // the lambda-return of the position after the move
+		float next_value = -1; // the value of the position after the move
+		for (size_t t = path.size() - 1; t-- > 0; ) {
+			float target = -((t + 2 == path.size()) ? next : (1 - lambda) * next_value + lambda * next);
+			float value = network.estimate(path[t]);
+			network.update(path[t], rate * (target - value));
+			next = target;
+			next_value = network.estimate(path[t]);
+		}
+	}
+
+private:
+	ntuple_network<float> network;
+	float alpha;
+	float lambda;
+	float epsilon;
+	size_t threads;
+	size_t checkpoint;
+	unsigned seed;
+	std::string save_path;
+};